@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/mem/Arena.h"
+
+#define ALLOCATION_COUNT (1024 * 1024)
+#define ALLOCATION_SIZE 24
+
+uint8_t memory[ALLOCATION_COUNT * 32];
+void* pointers[ALLOCATION_COUNT];
+
+// Allocate many small objects and release them all at once, the way arenas are used.
+
+void bench_malloc(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        for (size_t i = 0; i < ALLOCATION_COUNT; i += 1) {
+            pointers[i] = malloc(ALLOCATION_SIZE);
+            if (pointers[i] == NULL) {
+                abort();
+            }
+            *(size_t*)pointers[i] = i;
+        }
+        for (size_t i = 0; i < ALLOCATION_COUNT; i += 1) {
+            free(pointers[i]);
+        }
+    }
+}
+
+void bench_alloc(void* const context, uint64_t const iterations) {
+    Arena* const arena = context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        arena_reset(arena);
+        for (size_t i = 0; i < ALLOCATION_COUNT; i += 1) {
+            size_t* const pointer = arena_alloc(arena, ALLOCATION_SIZE);
+            if (pointer == NULL) {
+                abort();
+            }
+            *pointer = i;
+        }
+    }
+}
+
+void bench_alloc_nozero(void* const context, uint64_t const iterations) {
+    Arena* const arena = context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        arena_reset(arena);
+        for (size_t i = 0; i < ALLOCATION_COUNT; i += 1) {
+            size_t* const pointer = arena_alloc_nozero(arena, ALLOCATION_SIZE);
+            if (pointer == NULL) {
+                abort();
+            }
+            *pointer = i;
+        }
+    }
+}
+
+// Grow one allocation in place, the way growing builders and vectors do.
+void bench_realloc_last(void* const context, uint64_t const iterations) {
+    Arena* const arena = context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        arena_reset(arena);
+        uint8_t* const pointer = arena_alloc_nozero(arena, ALLOCATION_SIZE);
+        for (size_t i = 1; i < ALLOCATION_COUNT; i += 1) {
+            if (arena_realloc_last(arena, pointer, i * ALLOCATION_SIZE, (i + 1) * ALLOCATION_SIZE) == NULL) {
+                abort();
+            }
+            pointer[i * ALLOCATION_SIZE] = (uint8_t)i;
+        }
+        bench_clobber();
+    }
+}
+
+// Times are per allocation.
+int main(void) {
+    Arena arena = arena_create(memory, sizeof(memory));
+
+    struct {
+        char const* name;
+        Bench_Function function;
+    } const benches[] = {
+        { "arena/malloc_free", bench_malloc },
+        { "arena/alloc", bench_alloc },
+        { "arena/alloc_nozero", bench_alloc_nozero },
+        { "arena/realloc_last", bench_realloc_last },
+    };
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i += 1) {
+        bench_report(bench_run(&(Bench) {
+            .name = benches[i].name,
+            .function = benches[i].function,
+            .context = &arena,
+            .operations = ALLOCATION_COUNT,
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/mem/Arena.h"
+#include "../chimp/mem/Atomic_Arena.h"
+
+#define MAX_THREADS 8
+#define ALLOCATIONS_PER_THREAD (512 * 1024)
+#define ALLOCATION_SIZE 16
+#define CHUNK_SIZE (64 * 1024)
+
+typedef enum {
+    MODE_MUTEX,
+    MODE_ATOMIC,
+    MODE_LOCAL,
+} Mode;
+
+typedef struct Shared Shared;
+struct Shared {
+    Mode mode;
+    pthread_mutex_t mutex;
+    Arena* arena;
+    Atomic_Arena* atomic_arena;
+};
+
+void* worker_run(void* const argument) {
+    Shared* const shared = argument;
+    Atomic_Arena_Local local = atomic_arena_local_create(shared->atomic_arena, CHUNK_SIZE);
+
+    for (size_t i = 0; i < ALLOCATIONS_PER_THREAD; i += 1) {
+        void* pointer = NULL;
+        switch (shared->mode) {
+            case MODE_MUTEX:
+                pthread_mutex_lock(&shared->mutex);
+                pointer = arena_alloc(shared->arena, ALLOCATION_SIZE);
+                pthread_mutex_unlock(&shared->mutex);
+                break;
+            case MODE_ATOMIC:
+                pointer = atomic_arena_alloc(shared->atomic_arena, ALLOCATION_SIZE);
+                break;
+            case MODE_LOCAL:
+                pointer = atomic_arena_local_alloc(&local, ALLOCATION_SIZE);
+                break;
+        }
+        if (pointer == NULL) {
+            abort();
+        }
+        *(size_t*)pointer = i;
+    }
+
+    return NULL;
+}
+
+typedef struct Context Context;
+struct Context {
+    Mode mode;
+    int thread_count;
+    uint8_t* buffer;
+    size_t buffer_size;
+};
+
+void bench_threads(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        Arena arena = arena_create(context->buffer, context->buffer_size);
+        Atomic_Arena atomic_arena = atomic_arena_create(context->buffer, context->buffer_size);
+        Shared shared = {
+            .mode = context->mode,
+            .arena = &arena,
+            .atomic_arena = &atomic_arena,
+        };
+        pthread_mutex_init(&shared.mutex, NULL);
+        pthread_t threads[MAX_THREADS];
+
+        for (int t = 0; t < context->thread_count; t += 1) {
+            if (pthread_create(&threads[t], NULL, worker_run, &shared) != 0) {
+                abort();
+            }
+        }
+        for (int t = 0; t < context->thread_count; t += 1) {
+            pthread_join(threads[t], NULL);
+        }
+
+        pthread_mutex_destroy(&shared.mutex);
+    }
+}
+
+// Times are per allocation over all threads, so perfect scaling halves them as the threads double.
+int main(void) {
+    size_t const buffer_size = (size_t)MAX_THREADS * (ALLOCATIONS_PER_THREAD * ALLOCATION_SIZE + 2 * CHUNK_SIZE);
+    uint8_t* const buffer = malloc(buffer_size);
+    if (buffer == NULL) {
+        abort();
+    }
+    memset(buffer, 0, buffer_size);
+
+    char const* const names[] = {
+        [MODE_MUTEX] = "mutex_arena_alloc",
+        [MODE_ATOMIC] = "alloc",
+        [MODE_LOCAL] = "local_alloc",
+    };
+
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        for (Mode mode = MODE_MUTEX; mode <= MODE_LOCAL; mode += 1) {
+            char name[64];
+            snprintf(name, sizeof(name), "atomic_arena/%s/%d_threads", names[mode], threads);
+            Context context = {
+                .mode = mode,
+                .thread_count = threads,
+                .buffer = buffer,
+                .buffer_size = buffer_size,
+            };
+            bench_report(bench_run(&(Bench) {
+                .name = name,
+                .function = bench_threads,
+                .context = &context,
+                .operations = (uint64_t)threads * ALLOCATIONS_PER_THREAD,
+            }));
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/io/File_Reader.h"
+
+#define FILE_SIZE (16 * 1024 * 1024)
+#define READER_BUFFER_SIZE (4 * 1024)
+
+typedef struct Context Context;
+struct Context {
+    FILE* file;
+    char* output;
+    size_t chunk_size;
+};
+
+size_t read_fread(Context const* const context) {
+    rewind(context->file);
+    size_t total = 0;
+    size_t n = 0;
+    while ((n = fread(context->output, 1, context->chunk_size, context->file)) > 0) {
+        total += n;
+    }
+    return total;
+}
+
+size_t read_bytes(Context const* const context) {
+    rewind(context->file);
+    static char buffer[READER_BUFFER_SIZE];
+    File_Reader reader = file_reader_create(context->file, buffer, sizeof(buffer));
+    size_t total = 0;
+    size_t n = 0;
+    while ((n = file_reader_read_bytes(&reader, context->output, context->chunk_size)) > 0) {
+        total += n;
+    }
+    return total;
+}
+
+size_t read_byte_loop(Context const* const context) {
+    rewind(context->file);
+    static char buffer[READER_BUFFER_SIZE];
+    File_Reader reader = file_reader_create(context->file, buffer, sizeof(buffer));
+    size_t total = 0;
+    for (;;) {
+        size_t n = 0;
+        while (n < context->chunk_size && file_reader_refresh(&reader) != EOF) {
+            context->output[n] = file_reader_read_byte(&reader);
+            n += 1;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    return total;
+}
+
+// Read the whole file with each reader, checking that nothing was lost.
+#define DEFINE_BENCH(name, reader)                                  \
+    void name(void* const context, uint64_t const iterations) {     \
+        for (uint64_t i = 0; i < iterations; i += 1) {              \
+            if (reader(context) != FILE_SIZE) {                     \
+                abort();                                            \
+            }                                                       \
+        }                                                           \
+    }
+
+DEFINE_BENCH(bench_fread, read_fread)
+DEFINE_BENCH(bench_read_bytes, read_bytes)
+DEFINE_BENCH(bench_read_byte_loop, read_byte_loop)
+
+void run(char const* const name, Bench_Function const function, Context* const context) {
+    bench_report(bench_run(&(Bench) {
+        .name = name,
+        .function = function,
+        .context = context,
+        .operations = FILE_SIZE,
+        .bytes = FILE_SIZE,
+    }));
+}
+
+// Times are per byte read.
+int main(void) {
+    FILE* file = tmpfile();
+    if (file == NULL) {
+        return 1;
+    }
+
+    char* const output = malloc(1024 * 1024);
+    if (output == NULL) {
+        return 1;
+    }
+    for (size_t i = 0; i < 1024 * 1024; i += 1) {
+        output[i] = (char)(i * 31);
+    }
+    for (size_t i = 0; i < FILE_SIZE / (1024 * 1024); i += 1) {
+        fwrite(output, 1, 1024 * 1024, file);
+    }
+
+    Context small = { .file = file, .output = output, .chunk_size = 100 };
+    Context large = { .file = file, .output = output, .chunk_size = 64 * 1024 };
+
+    run("file_reader/fread_100B", bench_fread, &small);
+    run("file_reader/read_bytes_100B", bench_read_bytes, &small);
+    run("file_reader/read_byte_100B", bench_read_byte_loop, &small);
+    run("file_reader/fread_64KiB", bench_fread, &large);
+    run("file_reader/read_bytes_64KiB", bench_read_bytes, &large);
+
+    free(output);
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/containers/Hash_Map.h"
+
+#define KEY_COUNT (256 * 1024)
+
+HASH_MAP_DEFINE(U64_Map, u64_map, uint64_t, uint64_t, hash_map_hash_u64, hash_map_equal_u64)
+
+// The kind of table that gets written next to an arena when there is no hash map:
+// a bucket array of linked nodes, doubled when there are more nodes than buckets.
+typedef struct Chained_Node Chained_Node;
+struct Chained_Node {
+    uint64_t key;
+    uint64_t value;
+    Chained_Node* next;
+};
+
+typedef struct Chained_Table Chained_Table;
+struct Chained_Table {
+    Arena* arena;
+    Chained_Node** buckets;
+    size_t bucket_count;
+    size_t count;
+};
+
+Chained_Table chained_create(Arena* const arena) {
+    Chained_Table table = { .arena = arena, .buckets = NULL, .bucket_count = 16, .count = 0 };
+    table.buckets = arena_alloc(arena, table.bucket_count * sizeof(Chained_Node*));
+    if (table.buckets == NULL) {
+        abort();
+    }
+    return table;
+}
+
+uint64_t* chained_find(
+    Chained_Table const* const table,
+    uint64_t const key
+) {
+    Chained_Node* node = table->buckets[hash_map_hash_u64(key) & (table->bucket_count - 1)];
+    for (; node != NULL; node = node->next) {
+        if (node->key == key) {
+            return &node->value;
+        }
+    }
+    return NULL;
+}
+
+void chained_insert(
+    Chained_Table* const table,
+    uint64_t const key,
+    uint64_t const value
+) {
+    uint64_t* const existing = chained_find(table, key);
+    if (existing != NULL) {
+        *existing = value;
+        return;
+    }
+
+    if (table->count == table->bucket_count) {
+        size_t const bucket_count = table->bucket_count * 2;
+        Chained_Node** const buckets = arena_alloc(table->arena, bucket_count * sizeof(Chained_Node*));
+        if (buckets == NULL) {
+            abort();
+        }
+        for (size_t i = 0; i < table->bucket_count; i += 1) {
+            Chained_Node* node = table->buckets[i];
+            while (node != NULL) {
+                Chained_Node* const next = node->next;
+                size_t const bucket = hash_map_hash_u64(node->key) & (bucket_count - 1);
+                node->next = buckets[bucket];
+                buckets[bucket] = node;
+                node = next;
+            }
+        }
+        table->buckets = buckets;
+        table->bucket_count = bucket_count;
+    }
+
+    Chained_Node* const node = arena_alloc_nozero(table->arena, sizeof(Chained_Node));
+    if (node == NULL) {
+        abort();
+    }
+    size_t const bucket = hash_map_hash_u64(key) & (table->bucket_count - 1);
+    *node = (Chained_Node) { .key = key, .value = value, .next = table->buckets[bucket] };
+    table->buckets[bucket] = node;
+    table->count += 1;
+}
+
+typedef struct Context Context;
+struct Context {
+    Arena* arena;
+    uint64_t const* keys;
+    uint64_t const* misses;
+    Chained_Table const* chained;
+    U64_Map const* map;
+};
+
+void bench_chained_insert(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        arena_reset(context->arena);
+        Chained_Table table = chained_create(context->arena);
+        for (size_t i = 0; i < KEY_COUNT; i += 1) {
+            chained_insert(&table, context->keys[i], i);
+        }
+        bench_do_not_optimize(table.count);
+    }
+}
+
+void bench_insert(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        arena_reset(context->arena);
+        U64_Map map = u64_map_create(context->arena);
+        for (size_t i = 0; i < KEY_COUNT; i += 1) {
+            if (u64_map_insert(&map, context->keys[i], i) != 0) {
+                abort();
+            }
+        }
+        bench_do_not_optimize(map.table.count);
+    }
+}
+
+void bench_insert_reserved(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        arena_reset(context->arena);
+        U64_Map map = u64_map_create(context->arena);
+        if (u64_map_reserve(&map, KEY_COUNT) != 0) {
+            abort();
+        }
+        for (size_t i = 0; i < KEY_COUNT; i += 1) {
+            if (u64_map_insert(&map, context->keys[i], i) != 0) {
+                abort();
+            }
+        }
+        bench_do_not_optimize(map.table.count);
+    }
+}
+
+void bench_chained_find_hit(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < KEY_COUNT; i += 1) {
+            uint64_t const* const value = chained_find(context->chained, context->keys[i]);
+            if (value == NULL) {
+                abort();
+            }
+            sum += *value;
+        }
+        if (sum != (uint64_t)KEY_COUNT * (KEY_COUNT - 1) / 2) {
+            abort();
+        }
+    }
+}
+
+void bench_find_hit(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < KEY_COUNT; i += 1) {
+            uint64_t const* const value = u64_map_find(context->map, context->keys[i]);
+            if (value == NULL) {
+                abort();
+            }
+            sum += *value;
+        }
+        if (sum != (uint64_t)KEY_COUNT * (KEY_COUNT - 1) / 2) {
+            abort();
+        }
+    }
+}
+
+void bench_chained_find_miss(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        size_t found = 0;
+        for (size_t i = 0; i < KEY_COUNT; i += 1) {
+            found += chained_find(context->chained, context->misses[i]) != NULL;
+        }
+        if (found != 0) {
+            abort();
+        }
+    }
+}
+
+void bench_find_miss(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        size_t found = 0;
+        for (size_t i = 0; i < KEY_COUNT; i += 1) {
+            found += u64_map_find(context->map, context->misses[i]) != NULL;
+        }
+        if (found != 0) {
+            abort();
+        }
+    }
+}
+
+// Times are per key.
+int main(void) {
+    // Odd keys are inserted and even keys are looked up as misses.
+    uint64_t* const keys = malloc(2 * KEY_COUNT * sizeof(uint64_t));
+    size_t const memory_size = 128 * KEY_COUNT;
+    uint8_t* const memory = malloc(3 * memory_size);
+    if (keys == NULL || memory == NULL) {
+        return 1;
+    }
+
+    uint64_t state = 1;
+    for (size_t i = 0; i < KEY_COUNT; i += 1) {
+        state += 0x9E3779B97F4A7C15ull;
+        keys[i] = hash_map_hash_u64(state) | 1;
+        keys[KEY_COUNT + i] = keys[i] - 1;
+    }
+
+    Arena arena = arena_create(memory, memory_size);
+    Arena chained_arena = arena_create(memory + memory_size, memory_size);
+    Arena map_arena = arena_create(memory + 2 * memory_size, memory_size);
+
+    Chained_Table chained = chained_create(&chained_arena);
+    U64_Map map = u64_map_create(&map_arena);
+    for (size_t i = 0; i < KEY_COUNT; i += 1) {
+        chained_insert(&chained, keys[i], i);
+        if (u64_map_insert(&map, keys[i], i) != 0) {
+            return 1;
+        }
+    }
+
+    Context context = {
+        .arena = &arena,
+        .keys = keys,
+        .misses = keys + KEY_COUNT,
+        .chained = &chained,
+        .map = &map,
+    };
+
+    struct {
+        char const* name;
+        Bench_Function function;
+    } const benches[] = {
+        { "hash_map/chained_insert", bench_chained_insert },
+        { "hash_map/insert", bench_insert },
+        { "hash_map/insert_reserved", bench_insert_reserved },
+        { "hash_map/chained_find_hit", bench_chained_find_hit },
+        { "hash_map/find_hit", bench_find_hit },
+        { "hash_map/chained_find_miss", bench_chained_find_miss },
+        { "hash_map/find_miss", bench_find_miss },
+    };
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i += 1) {
+        bench_report(bench_run(&(Bench) {
+            .name = benches[i].name,
+            .function = benches[i].function,
+            .context = &context,
+            .operations = KEY_COUNT,
+        }));
+    }
+
+    free(memory);
+    free(keys);
+    return 0;
+}
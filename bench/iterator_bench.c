@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/io/File_Iterator.h"
+#include "../chimp/strings/String_Iterator.h"
+
+#define TEXT_LENGTH (16 * 1024 * 1024)
+
+char text[TEXT_LENGTH];
+uint8_t memory[16 * 1024 * 1024];
+size_t expected_words = 0;
+size_t expected_lines = 0;
+
+// Count the words byte by byte, the inner loop of a simple tokenizer.
+void bench_string_next(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        String_Iterator iter = string_iterator_create(text, TEXT_LENGTH);
+        size_t words = 0;
+        int previous = ' ';
+        for (int byte = string_iterator_next(&iter).byte; byte != 0; byte = string_iterator_next(&iter).byte) {
+            words += byte > ' ' && previous <= ' ';
+            previous = byte;
+        }
+        if (words != expected_words) {
+            abort();
+        }
+    }
+}
+
+// The same without tracking lines and columns.
+void bench_string_next_byte(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        String_Iterator iter = string_iterator_create(text, TEXT_LENGTH);
+        size_t words = 0;
+        int previous = ' ';
+        for (int byte = string_iterator_next_byte(&iter); byte != 0; byte = string_iterator_next_byte(&iter)) {
+            words += byte > ' ' && previous <= ' ';
+            previous = byte;
+        }
+        if (words != expected_words) {
+            abort();
+        }
+    }
+}
+
+// Turn the last offset into a line and column with a fresh line index.
+void bench_string_locate(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        String_Iterator iter = string_iterator_create(text, TEXT_LENGTH);
+        string_iterator_skip(&iter, TEXT_LENGTH);
+        Arena arena = arena_create(memory, sizeof(memory));
+        Line_Index index = line_index_create(&arena);
+        string_iterator_sync_position(&iter, &index);
+        if (iter.position.line != expected_lines + 1) {
+            abort();
+        }
+    }
+}
+
+void bench_string_next_line(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        String_Iterator iter = string_iterator_create(text, TEXT_LENGTH);
+        while (iter.offset < iter.length) {
+            bench_do_not_optimize(string_iterator_next_line(&iter).length);
+        }
+        if (iter.position.line != expected_lines + 1) {
+            abort();
+        }
+    }
+}
+
+void bench_file_next(void* const context, uint64_t const iterations) {
+    FILE* const file = context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        rewind(file);
+        File_Iterator iter = file_iterator_create(file);
+        size_t words = 0;
+        int previous = ' ';
+        for (int byte = file_iterator_next(&iter).byte; byte != 0; byte = file_iterator_next(&iter).byte) {
+            words += byte > ' ' && previous <= ' ';
+            previous = byte;
+        }
+        if (words != expected_words) {
+            abort();
+        }
+    }
+}
+
+void bench_file_next_byte(void* const context, uint64_t const iterations) {
+    FILE* const file = context;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        rewind(file);
+        Arena arena = arena_create(memory, sizeof(memory));
+        Line_Index index = line_index_create(&arena);
+        File_Iterator iter = file_iterator_create_indexed(file, &index);
+        size_t words = 0;
+        int previous = ' ';
+        for (int byte = file_iterator_next_byte(&iter); byte != 0; byte = file_iterator_next_byte(&iter)) {
+            words += byte > ' ' && previous <= ' ';
+            previous = byte;
+        }
+        file_iterator_sync_position(&iter);
+        if (words != expected_words || iter.position.line != expected_lines + 1) {
+            abort();
+        }
+    }
+}
+
+void bench_file_read_line(void* const context, uint64_t const iterations) {
+    FILE* const file = context;
+    char line[4096];
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        rewind(file);
+        File_Iterator iter = file_iterator_create(file);
+        while (file_iterator_read_line(&iter, line, sizeof(line)) > 0) {
+        }
+        if (iter.position.line != expected_lines + 1) {
+            abort();
+        }
+    }
+}
+
+// Times are per byte of text.
+int main(void) {
+    srand(1);
+    int previous = ' ';
+    for (size_t i = 0; i < TEXT_LENGTH; i += 1) {
+        int const r = rand() % 40;
+        text[i] = r == 0 ? '\n' : r < 6 ? ' ' : (char)('A' + r);
+        expected_words += text[i] > ' ' && previous <= ' ';
+        expected_lines += text[i] == '\n';
+        previous = text[i];
+    }
+
+    FILE* const file = tmpfile();
+    if (file == NULL || fwrite(text, 1, TEXT_LENGTH, file) != TEXT_LENGTH) {
+        return 1;
+    }
+
+    struct {
+        char const* name;
+        Bench_Function function;
+        void* context;
+    } const benches[] = {
+        { "string_iterator/next", bench_string_next, NULL },
+        { "string_iterator/next_byte", bench_string_next_byte, NULL },
+        { "string_iterator/locate", bench_string_locate, NULL },
+        { "string_iterator/next_line", bench_string_next_line, NULL },
+        { "file_iterator/next", bench_file_next, file },
+        { "file_iterator/next_byte_indexed", bench_file_next_byte, file },
+        { "file_iterator/read_line", bench_file_read_line, file },
+    };
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i += 1) {
+        bench_report(bench_run(&(Bench) {
+            .name = benches[i].name,
+            .function = benches[i].function,
+            .context = benches[i].context,
+            .operations = TEXT_LENGTH,
+            .bytes = TEXT_LENGTH,
+        }));
+    }
+
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/strings/parse.h"
+
+#define COUNT (1024 * 1024)
+
+// Numbers separated by single spaces, the text is NUL-terminated for strtoll and strtod.
+char integers[COUNT * 21 + 1];
+char floats[COUNT * 32 + 1];
+size_t integers_length = 0;
+size_t floats_length = 0;
+
+// Every benchmark sums the numbers into the context, to check it against the C library.
+
+void bench_strtoll(void* const context, uint64_t const iterations) {
+    int64_t sum = 0;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        sum = 0;
+        for (char* cursor = integers; *cursor != 0; cursor += 1) {
+            sum += strtoll(cursor, &cursor, 10);
+        }
+    }
+    *(int64_t*)context = sum;
+}
+
+void bench_parse_i64(void* const context, uint64_t const iterations) {
+    int64_t sum = 0;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        sum = 0;
+        for (size_t offset = 0; offset < integers_length; offset += 1) {
+            int64_t value = 0;
+            size_t consumed = 0;
+            if (parse_i64(integers + offset, integers_length - offset, &value, &consumed)) {
+                abort();
+            }
+            sum += value;
+            offset += consumed;
+        }
+    }
+    *(int64_t*)context = sum;
+}
+
+void bench_strtod(void* const context, uint64_t const iterations) {
+    double sum = 0;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        sum = 0;
+        for (char* cursor = floats; *cursor != 0; cursor += 1) {
+            sum += strtod(cursor, &cursor);
+        }
+    }
+    *(double*)context = sum;
+}
+
+void bench_parse_f64(void* const context, uint64_t const iterations) {
+    double sum = 0;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        sum = 0;
+        for (size_t offset = 0; offset < floats_length; offset += 1) {
+            double value = 0;
+            size_t consumed = 0;
+            if (parse_f64(floats + offset, floats_length - offset, &value, &consumed)) {
+                abort();
+            }
+            sum += value;
+            offset += consumed;
+        }
+    }
+    *(double*)context = sum;
+}
+
+void run(char const* const name, Bench_Function const function, void* const context, size_t const length) {
+    bench_report(bench_run(&(Bench) {
+        .name = name,
+        .function = function,
+        .context = context,
+        .operations = COUNT,
+        .bytes = length,
+    }));
+}
+
+// Parse the same text with the C library and with parse.h, checking that they agree.
+// Times are per number.
+int main(void) {
+    uint64_t bits = 0x2545F4914F6CDD1Dull;
+
+    for (size_t i = 0; i < COUNT; i += 1) {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        integers_length += (size_t)sprintf(integers + integers_length, "%lld ", (long long)(bits >> (bits & 63)));
+        floats_length += (size_t)sprintf(floats + floats_length, "%.17g ", (double)(bits >> 11) / (double)(1 << (bits & 31)));
+    }
+
+    int64_t strtoll_sum = 0;
+    int64_t i64_sum = 0;
+    double strtod_sum = 0;
+    double f64_sum = 0;
+
+    run("parse/strtoll", bench_strtoll, &strtoll_sum, integers_length);
+    run("parse/parse_i64", bench_parse_i64, &i64_sum, integers_length);
+    run("parse/strtod", bench_strtod, &strtod_sum, floats_length);
+    run("parse/parse_f64", bench_parse_f64, &f64_sum, floats_length);
+
+    if (strtoll_sum != i64_sum || strtod_sum != f64_sum) {
+        fprintf(stderr, "The parsers disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/mem/Pool.h"
+
+#define OBJECT_COUNT (256 * 1024)
+#define OBJECT_SIZE 48
+
+typedef struct Context Context;
+struct Context {
+    uint8_t* buffer;
+    size_t buffer_size;
+    size_t const* order;
+};
+
+void* objects[OBJECT_COUNT];
+
+// Allocate every object and free them in a shuffled order, twice, so that the
+// second round reuses freed memory.
+void bench_malloc(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        for (int round = 0; round < 2; round += 1) {
+            for (size_t i = 0; i < OBJECT_COUNT; i += 1) {
+                objects[i] = malloc(OBJECT_SIZE);
+                if (objects[i] == NULL) {
+                    abort();
+                }
+                *(size_t*)objects[i] = i;
+            }
+            for (size_t i = 0; i < OBJECT_COUNT; i += 1) {
+                free(objects[context->order[i]]);
+            }
+        }
+    }
+}
+
+void bench_pool(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        Pool pool = pool_create(context->buffer, context->buffer_size, OBJECT_SIZE);
+        for (int round = 0; round < 2; round += 1) {
+            for (size_t i = 0; i < OBJECT_COUNT; i += 1) {
+                objects[i] = pool_alloc(&pool);
+                if (objects[i] == NULL) {
+                    abort();
+                }
+                *(size_t*)objects[i] = i;
+            }
+            for (size_t i = 0; i < OBJECT_COUNT; i += 1) {
+                pool_free(&pool, objects[context->order[i]]);
+            }
+        }
+    }
+}
+
+void bench_pool_cache(void* const argument, uint64_t const iterations) {
+    Context const* const context = argument;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        Pool pool = pool_create(context->buffer, context->buffer_size, OBJECT_SIZE);
+        Pool_Cache cache = pool_cache_create(&pool, 256);
+        for (int round = 0; round < 2; round += 1) {
+            for (size_t i = 0; i < OBJECT_COUNT; i += 1) {
+                objects[i] = pool_cache_alloc(&cache);
+                if (objects[i] == NULL) {
+                    abort();
+                }
+                *(size_t*)objects[i] = i;
+            }
+            for (size_t i = 0; i < OBJECT_COUNT; i += 1) {
+                pool_cache_free(&cache, objects[context->order[i]]);
+            }
+        }
+    }
+}
+
+// Times are per allocation or free.
+int main(void) {
+    size_t* const order = malloc(OBJECT_COUNT * sizeof(size_t));
+    if (order == NULL) {
+        return 1;
+    }
+    for (size_t i = 0; i < OBJECT_COUNT; i += 1) {
+        order[i] = i;
+    }
+    srand(1);
+    for (size_t i = OBJECT_COUNT - 1; i > 0; i -= 1) {
+        size_t const j = (size_t)rand() % (i + 1);
+        size_t const tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    size_t const buffer_size = OBJECT_COUNT * pool_object_size(OBJECT_SIZE) + 64;
+    uint8_t* const buffer = malloc(buffer_size);
+    if (buffer == NULL) {
+        return 1;
+    }
+    memset(buffer, 0, buffer_size);
+
+    Context context = { .buffer = buffer, .buffer_size = buffer_size, .order = order };
+    Bench_Function const functions[] = { bench_malloc, bench_pool, bench_pool_cache };
+    char const* const names[] = { "pool/malloc_free", "pool/alloc_free", "pool/cache_alloc_free" };
+
+    for (size_t i = 0; i < 3; i += 1) {
+        bench_report(bench_run(&(Bench) {
+            .name = names[i],
+            .function = functions[i],
+            .context = &context,
+            .operations = 4 * OBJECT_COUNT,
+        }));
+    }
+
+    free(buffer);
+    free(order);
+    return 0;
+}
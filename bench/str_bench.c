@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/strings/Str.h"
+
+#define TEXT_LENGTH (16 * 1024 * 1024)
+
+char text[TEXT_LENGTH + 1];
+char const needle[] = "needle in a haystack";
+size_t const expected = TEXT_LENGTH - sizeof(needle) + 1;
+
+// Search for a needle that is placed at the very end, so every search scans the whole text.
+// The clobber keeps the compiler from searching only once.
+
+void bench_strstr(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_clobber();
+        char const* const found = strstr(text, needle);
+        if (found != text + expected) {
+            abort();
+        }
+    }
+}
+
+void bench_scalar(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_clobber();
+        size_t const index = scan_find_substring_scalar(text, TEXT_LENGTH, needle, sizeof(needle) - 1);
+        if (index != expected) {
+            abort();
+        }
+    }
+}
+
+void bench_find(void* const context, uint64_t const iterations) {
+    Str const haystack = *(Str const*)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_clobber();
+        size_t const index = str_find(haystack, STR_LITERAL(needle));
+        if (index != expected) {
+            abort();
+        }
+    }
+}
+
+// Times are per byte searched.
+int main(void) {
+    srand(1);
+    for (size_t i = 0; i < TEXT_LENGTH; i += 1) {
+        text[i] = (char)('a' + rand() % 26);
+    }
+    memcpy(text + expected, needle, sizeof(needle) - 1);
+    text[TEXT_LENGTH] = 0;
+
+    Str haystack = str_create(text, TEXT_LENGTH);
+    Bench_Function const functions[] = { bench_strstr, bench_scalar, bench_find };
+    char const* const names[] = { "str/strstr", "str/scan_find_substring_scalar", "str/find" };
+
+    for (size_t i = 0; i < 3; i += 1) {
+        bench_report(bench_run(&(Bench) {
+            .name = names[i],
+            .function = functions[i],
+            .context = &haystack,
+            .operations = TEXT_LENGTH,
+            .bytes = TEXT_LENGTH,
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/strings/String_Builder.h"
+
+#define VALUE_COUNT (256 * 1024)
+#define TEXT_LENGTH (8 * 1024 * 1024)
+
+// Room for every value, or for the text with every byte escaped.
+#define OUTPUT_SIZE (2 * TEXT_LENGTH + 2)
+
+int64_t values[VALUE_COUNT];
+double doubles[VALUE_COUNT];
+char output[OUTPUT_SIZE];
+char text[TEXT_LENGTH];
+
+// Every benchmark writes its output length into the context, to check it against the others.
+
+void bench_snprintf(void* const context, uint64_t const iterations) {
+    size_t n = 0;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        n = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            n += (size_t)snprintf(output + n, sizeof(output) - n, "%lld", (long long)values[i]);
+        }
+    }
+    *(size_t*)context = n;
+}
+
+void bench_write_int(void* const context, uint64_t const iterations) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        builder.length = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            if (string_builder_write_int(&builder, values[i])) {
+                abort();
+            }
+        }
+    }
+    *(size_t*)context = builder.length;
+}
+
+void bench_snprintf_g(void* const context, uint64_t const iterations) {
+    size_t n = 0;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        n = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            n += (size_t)snprintf(output + n, sizeof(output) - n, "%.17g", doubles[i]);
+        }
+    }
+    *(size_t*)context = n;
+}
+
+void bench_write_f64(void* const context, uint64_t const iterations) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        builder.length = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            if (string_builder_write_f64(&builder, doubles[i])) {
+                abort();
+            }
+        }
+    }
+    *(size_t*)context = builder.length;
+}
+
+void bench_snprintf_f(void* const context, uint64_t const iterations) {
+    size_t n = 0;
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        n = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            n += (size_t)snprintf(output + n, sizeof(output) - n, "%.3f", doubles[i]);
+        }
+    }
+    *(size_t*)context = n;
+}
+
+void bench_write_f64_fixed(void* const context, uint64_t const iterations) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        builder.length = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            if (string_builder_write_f64_fixed(&builder, doubles[i], 3)) {
+                abort();
+            }
+        }
+    }
+    *(size_t*)context = builder.length;
+}
+
+void bench_printf_line(void* const context, uint64_t const iterations) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        builder.length = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            if (string_builder_printf(&builder, "id=%lld index=%zu\n", (long long)values[i], i)) {
+                abort();
+            }
+        }
+    }
+    *(size_t*)context = builder.length;
+}
+
+void bench_print_line(void* const context, uint64_t const iterations) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        builder.length = 0;
+        for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+            if (string_builder_print(&builder, "id=", values[i], " index=", i, "\n")) {
+                abort();
+            }
+        }
+    }
+    *(size_t*)context = builder.length;
+}
+
+// Escape one byte at a time, the way the emitters did it by hand.
+void bench_json_bytewise(void* const context, uint64_t const iterations) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        builder.length = 0;
+        if (string_builder_write_byte(&builder, '"')) {
+            abort();
+        }
+        for (size_t i = 0; i < TEXT_LENGTH; i += 1) {
+            char const byte = text[i];
+            String_Builder_Error error = STRING_BUILDER_ERROR_NONE;
+            if (byte == '"' || byte == '\\') {
+                error = string_builder_write_byte(&builder, '\\') || string_builder_write_byte(&builder, byte);
+            } else if (byte == '\n') {
+                error = string_builder_write_bytes(&builder, "\\n", 2);
+            } else {
+                error = string_builder_write_byte(&builder, byte);
+            }
+            if (error) {
+                abort();
+            }
+        }
+        if (string_builder_write_byte(&builder, '"')) {
+            abort();
+        }
+    }
+    *(size_t*)context = builder.length;
+}
+
+void bench_json_string(void* const context, uint64_t const iterations) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        builder.length = 0;
+        if (string_builder_write_json_string(&builder, text, TEXT_LENGTH)) {
+            abort();
+        }
+    }
+    *(size_t*)context = builder.length;
+}
+
+void bench_memcpy(void* const context, uint64_t const iterations) {
+    for (uint64_t iteration = 0; iteration < iterations; iteration += 1) {
+        memcpy(output, text, TEXT_LENGTH);
+        bench_clobber();
+    }
+    *(size_t*)context = TEXT_LENGTH;
+}
+
+// Run the benchmarks in pairs that must write the same number of bytes.
+void run_pair(
+    char const* const first_name,
+    Bench_Function const first,
+    char const* const second_name,
+    Bench_Function const second,
+    uint64_t const operations,
+    uint64_t const bytes
+) {
+    size_t first_length = 0;
+    size_t second_length = 0;
+    bench_report(bench_run(&(Bench) {
+        .name = first_name,
+        .function = first,
+        .context = &first_length,
+        .operations = operations,
+        .bytes = bytes,
+    }));
+    bench_report(bench_run(&(Bench) {
+        .name = second_name,
+        .function = second,
+        .context = &second_length,
+        .operations = operations,
+        .bytes = bytes,
+    }));
+    if (first_length != second_length) {
+        fprintf(stderr, "Output lengths differ: %zu != %zu\n", first_length, second_length);
+        exit(1);
+    }
+}
+
+// Times are per value written, or per byte of text escaped.
+int main(void) {
+    // Mix magnitudes so that the digit count isn't perfectly predictable.
+    srand(1);
+    for (size_t i = 0; i < VALUE_COUNT; i += 1) {
+        int64_t const value = ((int64_t)rand() << 31) ^ rand();
+        int const shift = rand() % 60;
+        values[i] = (i & 1) ? -(value >> shift) : (value >> shift);
+        doubles[i] = (double)values[i] / (double)(1 + rand() % 100000);
+    }
+
+    run_pair("string_builder/snprintf_lld", bench_snprintf, "string_builder/write_int", bench_write_int, VALUE_COUNT, 0);
+    run_pair("string_builder/snprintf_.3f", bench_snprintf_f, "string_builder/write_f64_fixed", bench_write_f64_fixed, VALUE_COUNT, 0);
+    run_pair("string_builder/printf_line", bench_printf_line, "string_builder/print_line", bench_print_line, VALUE_COUNT, 0);
+
+    // The shortest round-trip output is shorter than %.17g, so only the times compare.
+    size_t length = 0;
+    bench_report(bench_run(&(Bench) {
+        .name = "string_builder/snprintf_.17g",
+        .function = bench_snprintf_g,
+        .context = &length,
+        .operations = VALUE_COUNT,
+    }));
+    bench_report(bench_run(&(Bench) {
+        .name = "string_builder/write_f64",
+        .function = bench_write_f64,
+        .context = &length,
+        .operations = VALUE_COUNT,
+    }));
+
+    // Mostly clean text with a quote or a newline every few hundred bytes.
+    for (size_t i = 0; i < TEXT_LENGTH; i += 1) {
+        int const r = rand() % 400;
+        text[i] = r == 0 ? '"' : r == 1 ? '\n' : (char)('a' + r % 26);
+    }
+
+    run_pair("string_builder/json_bytewise", bench_json_bytewise, "string_builder/write_json_string", bench_json_string, TEXT_LENGTH, TEXT_LENGTH);
+    bench_report(bench_run(&(Bench) {
+        .name = "string_builder/memcpy",
+        .function = bench_memcpy,
+        .context = &length,
+        .operations = TEXT_LENGTH,
+        .bytes = TEXT_LENGTH,
+    }));
+    return 0;
+}
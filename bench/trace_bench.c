@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/trace.h"
+
+Trace_Buffer buffer;
+char output[LIBCHIMP_TRACE_EVENTS * 128];
+
+void bench_baseline(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_do_not_optimize(i);
+    }
+}
+
+void bench_ticks(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_do_not_optimize(trace_ticks());
+    }
+}
+
+void bench_zone(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        TRACE_ZONE("zone");
+        bench_do_not_optimize(i);
+    }
+}
+
+void bench_counter(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        TRACE_COUNTER("counter", i);
+    }
+}
+
+// A thread that isn't traced only pays for checking its buffer.
+void bench_untraced(void* const context, uint64_t const iterations) {
+    (void)context;
+    trace_thread_end();
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        TRACE_ZONE("zone");
+        bench_do_not_optimize(i);
+    }
+    trace_thread_buffer = &buffer;
+}
+
+// Write a full ring of zones as JSON.
+void bench_write_json(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        String_Builder builder = string_builder_create(output, sizeof(output));
+        if (trace_write_json(&builder)) {
+            abort();
+        }
+    }
+}
+
+// Times are per zone, counter or event written.
+int main(void) {
+    trace_thread_begin(&buffer, "main");
+
+    struct {
+        char const* name;
+        Bench_Function function;
+    } const benches[] = {
+        { "trace/baseline", bench_baseline },
+        { "trace/ticks", bench_ticks },
+        { "trace/zone", bench_zone },
+        { "trace/counter", bench_counter },
+        { "trace/zone_untraced_thread", bench_untraced },
+    };
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i += 1) {
+        bench_report(bench_run(&(Bench) {
+            .name = benches[i].name,
+            .function = benches[i].function,
+        }));
+    }
+
+    bench_report(bench_run(&(Bench) {
+        .name = "trace/write_json",
+        .function = bench_write_json,
+        .operations = LIBCHIMP_TRACE_EVENTS,
+    }));
+    return 0;
+}
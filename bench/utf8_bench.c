@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chimp/bench.h"
+#include "../chimp/strings/utf8.h"
+
+#define TEXT_LENGTH (16 * 1024 * 1024)
+
+char text[TEXT_LENGTH];
+size_t length = 0;
+size_t expected = 0;
+
+void bench_validate(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_clobber();
+        if (utf8_validate(text, length) != length) {
+            abort();
+        }
+    }
+}
+
+void bench_count_scalar(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_clobber();
+        if (utf8_count_code_points_scalar(text, length) != expected) {
+            abort();
+        }
+    }
+}
+
+void bench_count(void* const context, uint64_t const iterations) {
+    (void)context;
+    for (uint64_t i = 0; i < iterations; i += 1) {
+        bench_clobber();
+        if (utf8_count_code_points(text, length) != expected) {
+            abort();
+        }
+    }
+}
+
+// Validate and count text that is mostly ASCII with an occasional multi-byte code point.
+// Times are per byte.
+int main(void) {
+    srand(1);
+    while (length + 4 <= TEXT_LENGTH) {
+        uint32_t const code_point = rand() % 64 == 0 ? 0x80 + (uint32_t)(rand() % 0xD000) : 'a' + (uint32_t)(rand() % 26);
+        length += utf8_encode(code_point, text + length);
+        expected += 1;
+    }
+
+    Bench_Function const functions[] = { bench_validate, bench_count_scalar, bench_count };
+    char const* const names[] = { "utf8/validate", "utf8/count_code_points_scalar", "utf8/count_code_points" };
+
+    for (size_t i = 0; i < 3; i += 1) {
+        bench_report(bench_run(&(Bench) {
+            .name = names[i],
+            .function = functions[i],
+            .operations = length,
+            .bytes = length,
+        }));
+    }
+    return 0;
+}
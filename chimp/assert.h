@@ -23,8 +23,8 @@
 
     #define assert_equal(actual, expected)\
         do {                                                                                \
-            int64_t a = (int64_t)(actual);                                                  \
-            int64_t b = (int64_t)(expected);                                                \
+            long long a = (long long)(actual);                                              \
+            long long b = (long long)(expected);                                            \
             if (a != b) {                                                                   \
                 fprintf(                                                                    \
                     stderr,                                                                 \
@@ -0,0 +1,188 @@
+/*
+    A small microbenchmark harness.
+
+    Every benchmark is warmed up and calibrated first: the iteration count doubles until
+    one sample takes at least LIBCHIMP_BENCH_SAMPLE_SECONDS. Then LIBCHIMP_BENCH_SAMPLES
+    samples are timed with the monotonic clock, and with the time stamp counter on x86.
+    There are too few samples for tail percentiles, so the spread is shown by the fastest
+    and the slowest sample. The report is one line per benchmark with whitespace-separated
+    columns, so the output of two commits can be compared with diff or joined with awk:
+
+        # name                          min_ns   median_ns      max_ns   cycles   bytes_per_s
+        string_builder/write_int          8.81        8.95        9.40     31.2             0
+
+    Usage:
+        void bench_write_int(void* const context, uint64_t const iterations) {
+            for (uint64_t i = 0; i < iterations; i += 1) {
+                ...
+                bench_do_not_optimize(result);
+            }
+        }
+
+        bench_report(bench_run(&(Bench) {
+            .name = "string_builder/write_int",
+            .function = bench_write_int,
+            .context = &state,
+        }));
+*/
+
+#ifndef LIBCHIMP_BENCH_H
+#define LIBCHIMP_BENCH_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define LIBCHIMP_BENCH_RDTSC
+#endif
+
+// The number of timed samples per benchmark.
+#ifndef LIBCHIMP_BENCH_SAMPLES
+    #define LIBCHIMP_BENCH_SAMPLES 15
+#endif
+
+// The shortest time a sample may take, calibration raises the iteration count until it does.
+#ifndef LIBCHIMP_BENCH_SAMPLE_SECONDS
+    #define LIBCHIMP_BENCH_SAMPLE_SECONDS 0.01
+#endif
+
+// Make the compiler assume that the value is used, so that the work producing it is kept.
+// The value must be a scalar or a pointer.
+#define bench_do_not_optimize(value) __asm__ volatile("" : : "g"(value) : "memory")
+
+// Make the compiler assume that all memory is read and written.
+#define bench_clobber() __asm__ volatile("" : : : "memory")
+
+// Run the operation being measured the given number of times.
+typedef void (*Bench_Function)(void* context, uint64_t iterations);
+
+typedef struct Bench Bench;
+struct Bench {
+    char const* name;
+    Bench_Function function;
+    void* context;
+    // The operations done by one iteration, e.g. the length of an array processed as a whole.
+    // The times are reported per operation. 0 is taken as 1.
+    uint64_t operations;
+    // The bytes processed by one iteration, for the throughput. 0 if it doesn't apply.
+    uint64_t bytes;
+};
+
+// Times per operation, in nanoseconds and cycles.
+typedef struct Bench_Result Bench_Result;
+struct Bench_Result {
+    char const* name;
+    uint64_t iterations;
+    double min;
+    double median;
+    double max;
+    double cycles;
+    double bytes_per_second;
+};
+
+// Read the monotonic clock in nanoseconds.
+__attribute__((warn_unused_result))
+uint64_t bench_now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+}
+
+// Read the time stamp counter, or 0 if there isn't one.
+__attribute__((warn_unused_result))
+uint64_t bench_cycles(void) {
+#ifdef LIBCHIMP_BENCH_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Sort the samples in place, there are only a few of them.
+void bench_sort(
+    double* const samples,
+    size_t const count
+) {
+    for (size_t i = 1; i < count; i += 1) {
+        double const sample = samples[i];
+        size_t j = i;
+        while (j > 0 && samples[j - 1] > sample) {
+            samples[j] = samples[j - 1];
+            j -= 1;
+        }
+        samples[j] = sample;
+    }
+}
+
+// Warm up, calibrate and time the benchmark.
+__attribute__((warn_unused_result))
+Bench_Result bench_run(Bench const* const bench) {
+    assert(bench != NULL);
+    assert(bench->name != NULL);
+    assert(bench->function != NULL);
+
+    uint64_t const target = (uint64_t)(LIBCHIMP_BENCH_SAMPLE_SECONDS * 1e9);
+    uint64_t iterations = 1;
+
+    // The calibration runs double as the warmup.
+    for (;;) {
+        uint64_t const start = bench_now();
+        bench->function(bench->context, iterations);
+        uint64_t const elapsed = bench_now() - start;
+        if (elapsed >= target || iterations >= (UINT64_MAX >> 1)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double const operations = (double)iterations * (double)(bench->operations > 0 ? bench->operations : 1);
+    double samples[LIBCHIMP_BENCH_SAMPLES];
+    double cycles[LIBCHIMP_BENCH_SAMPLES];
+
+    for (size_t i = 0; i < LIBCHIMP_BENCH_SAMPLES; i += 1) {
+        uint64_t const start = bench_now();
+        uint64_t const start_cycles = bench_cycles();
+        bench->function(bench->context, iterations);
+        uint64_t const end_cycles = bench_cycles();
+        uint64_t const end = bench_now();
+        samples[i] = (double)(end - start) / operations;
+        cycles[i] = (double)(end_cycles - start_cycles) / operations;
+    }
+
+    bench_sort(samples, LIBCHIMP_BENCH_SAMPLES);
+    bench_sort(cycles, LIBCHIMP_BENCH_SAMPLES);
+
+    double const median = samples[LIBCHIMP_BENCH_SAMPLES / 2];
+    double const bytes_per_operation = (double)bench->bytes / (double)(bench->operations > 0 ? bench->operations : 1);
+
+    return (Bench_Result) {
+        .name = bench->name,
+        .iterations = iterations,
+        .min = samples[0],
+        .median = median,
+        .max = samples[LIBCHIMP_BENCH_SAMPLES - 1],
+        .cycles = cycles[LIBCHIMP_BENCH_SAMPLES / 2],
+        .bytes_per_second = median > 0 ? bytes_per_operation * 1e9 / median : 0,
+    };
+}
+
+// Print the result as one line, and the column names before the first result.
+void bench_report(Bench_Result const result) {
+    static int has_header = 0;
+
+    if (!has_header) {
+        printf("# %-46s %12s %12s %12s %10s %16s\n", "name", "min_ns", "median_ns", "max_ns", "cycles", "bytes_per_s");
+        has_header = 1;
+    }
+
+    printf(
+        "%-48s %12.2f %12.2f %12.2f %10.1f %16.0f\n",
+        result.name, result.min, result.median, result.max, result.cycles, result.bytes_per_second
+    );
+    fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,617 @@
+#ifndef LIBCHIMP_HASH_MAP_H
+#define LIBCHIMP_HASH_MAP_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../mem/Arena.h"
+#include "../scan.h"
+#include "../strings/Str.h"
+
+// The slots are probed a group at a time.
+#define HASH_MAP_GROUP_SIZE 16
+
+// Control bytes of slots without an entry. A full slot has the low 7 bits of its hash,
+// so the high bit tells full slots apart from the rest.
+#define HASH_MAP_EMPTY ((uint8_t)0x80)
+#define HASH_MAP_DELETED ((uint8_t)0xFE)
+
+// The untyped part of a hash map, see HASH_MAP_DEFINE.
+// Every slot has a control byte, and the control bytes of a group are matched against
+// a hash with one SSE2 compare, so a lookup rarely looks at an entry that doesn't match.
+// The groups are probed in a triangular sequence, which visits every group once because
+// the number of groups is a power of two. A probe stops at the first group with an empty slot.
+typedef struct Hash_Map_Table Hash_Map_Table;
+struct Hash_Map_Table {
+    uint8_t* control;
+    size_t capacity;
+    size_t count;
+    size_t growth_left;
+    Arena* arena;
+};
+
+//
+//  HASHING
+//
+
+// Mix the bits of an integer so that every input bit affects every output bit.
+__attribute__((warn_unused_result))
+uint64_t hash_map_hash_u64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+// Hash bytes eight at a time.
+__attribute__((warn_unused_result))
+uint64_t hash_map_hash_bytes(
+    void const* const data,
+    size_t const length
+) {
+    assert(data != NULL || length == 0);
+
+    uint8_t const* const bytes = data;
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t chunk = 0;
+        memcpy(&chunk, bytes + i, 8);
+        hash ^= chunk * 0x87C37B91114253D5ull;
+        hash = ((hash << 29) | (hash >> 35)) * 0x4CF5AD432745937Full;
+    }
+
+    if (i < length) {
+        uint64_t chunk = 0;
+        memcpy(&chunk, bytes + i, length - i);
+        hash ^= chunk * 0x87C37B91114253D5ull;
+    }
+
+    return hash_map_hash_u64(hash);
+}
+
+__attribute__((warn_unused_result))
+uint64_t hash_map_hash_str(Str const str) {
+    return hash_map_hash_bytes(str.data, str.length);
+}
+
+__attribute__((warn_unused_result))
+int hash_map_equal_u64(
+    uint64_t const first,
+    uint64_t const second
+) {
+    return first == second;
+}
+
+//
+//  GROUPS
+//
+
+// Get the bit mask of the slots in the group whose control byte is the byte.
+// The control bytes of a group are 16 byte aligned.
+__attribute__((warn_unused_result))
+uint32_t hash_map_group_match(
+    uint8_t const* const control,
+    uint8_t const byte
+) {
+#ifdef LIBCHIMP_SCAN_X86
+    __m128i const group = _mm_load_si128((__m128i const*)control);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < HASH_MAP_GROUP_SIZE; i += 1) {
+        mask |= (uint32_t)(control[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+// Get the bit mask of the slots in the group that are empty or deleted.
+__attribute__((warn_unused_result))
+uint32_t hash_map_group_match_available(uint8_t const* const control) {
+#ifdef LIBCHIMP_SCAN_X86
+    return (uint32_t)_mm_movemask_epi8(_mm_load_si128((__m128i const*)control));
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < HASH_MAP_GROUP_SIZE; i += 1) {
+        mask |= (uint32_t)(control[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+// Get the bit mask of the slots in the group that hold an entry.
+__attribute__((warn_unused_result))
+uint32_t hash_map_group_match_full(uint8_t const* const control) {
+    return ~hash_map_group_match_available(control) & 0xFFFF;
+}
+
+//
+//  TABLE
+//
+
+// Get the group where the probe for the hash starts, before masking.
+__attribute__((warn_unused_result))
+size_t hash_map_h1(uint64_t const hash) {
+    return (size_t)(hash >> 7);
+}
+
+// Get the control byte of a slot holding the hash.
+__attribute__((warn_unused_result))
+uint8_t hash_map_h2(uint64_t const hash) {
+    return (uint8_t)(hash & 0x7F);
+}
+
+// Get the number of entries a capacity can hold, 7/8 of it.
+__attribute__((warn_unused_result))
+size_t hash_map_max_load(size_t const capacity) {
+    return capacity - capacity / 8;
+}
+
+// Get the smallest capacity that holds count entries.
+__attribute__((warn_unused_result))
+size_t hash_map_capacity_for(size_t const count) {
+    size_t capacity = HASH_MAP_GROUP_SIZE;
+    while (hash_map_max_load(capacity) < count) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// Create an empty table. Nothing is allocated until the first insert.
+__attribute__((warn_unused_result))
+Hash_Map_Table hash_map_table_create(Arena* const arena) {
+    return (Hash_Map_Table) {
+        .control = NULL,
+        .capacity = 0,
+        .count = 0,
+        .growth_left = 0,
+        .arena = arena,
+    };
+}
+
+// Allocate the control bytes and entries for the capacity from the arena, all slots empty.
+// The table is left as it was if the allocation fails.
+// Return 0 if all is good.
+// Return 1 if the arena is full.
+__attribute__((warn_unused_result))
+int hash_map_table_allocate(
+    Hash_Map_Table* const table,
+    Arena* const arena,
+    size_t const capacity,
+    size_t const entry_size,
+    size_t const entry_alignment,
+    void** const entries
+) {
+    assert(table != NULL);
+    assert(arena != NULL);
+    assert(entries != NULL);
+    assert(capacity % HASH_MAP_GROUP_SIZE == 0);
+    assert(table->count <= hash_map_max_load(capacity));
+
+    if (capacity > SIZE_MAX / entry_size) {
+        return 1;
+    }
+
+    Arena_Mark const mark = arena_mark(arena);
+    uint8_t* const control = arena_alloc_aligned_nozero(arena, capacity, HASH_MAP_GROUP_SIZE);
+    void* const slots = control != NULL ? arena_alloc_aligned_nozero(arena, capacity * entry_size, entry_alignment) : NULL;
+
+    if (slots == NULL) {
+        arena_restore(arena, mark);
+        return 1;
+    }
+
+    memset(control, HASH_MAP_EMPTY, capacity);
+    table->control = control;
+    table->capacity = capacity;
+    table->growth_left = hash_map_max_load(capacity) - table->count;
+    *entries = slots;
+    return 0;
+}
+
+// Create a table with the largest capacity that fits the buffer.
+// The table can't grow, and has no capacity if even one group doesn't fit.
+__attribute__((warn_unused_result))
+Hash_Map_Table hash_map_table_create_buffer(
+    uint8_t* const buffer,
+    size_t const size,
+    size_t const entry_size,
+    size_t const entry_alignment,
+    void** const entries
+) {
+    assert(buffer != NULL);
+    assert(size > 0);
+    assert(entries != NULL);
+
+    Hash_Map_Table table = hash_map_table_create(NULL);
+    size_t const padding = HASH_MAP_GROUP_SIZE - 1 + entry_alignment - 1;
+    size_t capacity = 0;
+
+    for (size_t next = HASH_MAP_GROUP_SIZE; next <= size / (entry_size + 1); next *= 2) {
+        if (padding + next * (entry_size + 1) > size) {
+            break;
+        }
+        capacity = next;
+    }
+
+    if (capacity > 0) {
+        Arena arena = arena_create(buffer, size);
+        int const error = hash_map_table_allocate(&table, &arena, capacity, entry_size, entry_alignment, entries);
+        assert(error == 0);
+        (void)error;
+    }
+
+    return table;
+}
+
+// Find the first empty or deleted slot along the probe sequence of the hash.
+// The table always has one, because it is never filled past 7/8.
+__attribute__((warn_unused_result))
+size_t hash_map_table_find_available(
+    Hash_Map_Table const* const table,
+    uint64_t const hash
+) {
+    assert(table != NULL);
+    assert(table->capacity > 0);
+
+    size_t const group_mask = table->capacity / HASH_MAP_GROUP_SIZE - 1;
+    size_t group = hash_map_h1(hash) & group_mask;
+
+    for (size_t step = 1; ; step += 1) {
+        uint32_t const mask = hash_map_group_match_available(table->control + group * HASH_MAP_GROUP_SIZE);
+        if (mask != 0) {
+            return group * HASH_MAP_GROUP_SIZE + (size_t)__builtin_ctz(mask);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+// Remove the entry in the slot.
+// If the group still has an empty slot, no probe has ever gone past it, so the slot can
+// be emptied. Otherwise it is marked deleted to keep the probes going.
+void hash_map_table_erase_at(
+    Hash_Map_Table* const table,
+    size_t const index
+) {
+    assert(table != NULL);
+    assert(index < table->capacity);
+    assert(table->control[index] < HASH_MAP_EMPTY);
+
+    uint8_t const* const group = table->control + (index & ~(size_t)(HASH_MAP_GROUP_SIZE - 1));
+
+    if (hash_map_group_match(group, HASH_MAP_EMPTY) != 0) {
+        table->control[index] = HASH_MAP_EMPTY;
+        table->growth_left += 1;
+    } else {
+        table->control[index] = HASH_MAP_DELETED;
+    }
+
+    table->count -= 1;
+}
+
+// Find the next slot from the index that holds an entry.
+// Return the index of the slot, or the capacity if there are no more entries.
+__attribute__((warn_unused_result))
+size_t hash_map_table_next_full(
+    Hash_Map_Table const* const table,
+    size_t index
+) {
+    assert(table != NULL);
+
+    while (index < table->capacity) {
+        size_t const group = index & ~(size_t)(HASH_MAP_GROUP_SIZE - 1);
+        uint32_t const mask = hash_map_group_match_full(table->control + group) >> (index - group);
+        if (mask != 0) {
+            return index + (size_t)__builtin_ctz(mask);
+        }
+        index = group + HASH_MAP_GROUP_SIZE;
+    }
+
+    return table->capacity;
+}
+
+// Remove all entries, keeping the memory.
+void hash_map_table_clear(Hash_Map_Table* const table) {
+    assert(table != NULL);
+
+    if (table->capacity > 0) {
+        memset(table->control, HASH_MAP_EMPTY, table->capacity);
+    }
+
+    table->count = 0;
+    table->growth_left = hash_map_max_load(table->capacity);
+}
+
+//
+//  TYPED MAPS
+//
+
+// Define a hash map type specialized for the key and value types.
+// The hash function takes a key and returns an uint64_t, and the equal function takes
+// two keys and returns non-zero if they are equal. hash_map_hash_u64, hash_map_hash_str,
+// hash_map_equal_u64 and str_equal work as they are.
+//
+// The entries are stored by value next to each other, in an arena or a caller buffer.
+// A map over an arena doubles when it is full, leaving the old table in the arena.
+// A map over a buffer can't grow, reserve the capacity up front or use a big enough buffer.
+// Pointers to entries are invalidated by inserts and reserves.
+//
+// Usage:
+//     HASH_MAP_DEFINE(Word_Counts, word_counts, Str, uint64_t, hash_map_hash_str, str_equal)
+//
+//     Word_Counts counts = word_counts_create(&arena);
+//     uint64_t* const count = word_counts_find(&counts, word);
+//     if (count != NULL) {
+//         *count += 1;
+//     } else if (word_counts_insert(&counts, word, 1) != 0) {
+//         ...
+//     }
+//
+//     size_t index = 0;
+//     Word_Counts_Entry* entry;
+//     while (word_counts_next(&counts, &index, &entry)) {
+//         ...
+//     }
+//
+// The defined functions are:
+//     Map prefix_create(Arena* arena)
+//     Map prefix_create_buffer(uint8_t* buffer, size_t size)
+//     Value* prefix_find(Map const* map, Key key)                 NULL if the key is not in the map
+//     int prefix_insert(Map* map, Key key, Value value)           Replaces the value of an existing key
+//     int prefix_erase(Map* map, Key key)                         Return 1 if the key was in the map
+//     int prefix_reserve(Map* map, size_t count)                  Make room for count entries in total
+//     int prefix_next(Map const* map, size_t* index, Entry** entry)
+//     void prefix_clear(Map* map)
+// insert and reserve return 0 if all is good, 1 if the arena or buffer is full.
+#define HASH_MAP_DEFINE(Map, prefix, Key, Value, hash, equal)                                       \
+    typedef struct Map##_Entry Map##_Entry;                                                         \
+    struct Map##_Entry {                                                                            \
+        Key key;                                                                                    \
+        Value value;                                                                                \
+    };                                                                                              \
+                                                                                                    \
+    typedef struct Map Map;                                                                         \
+    struct Map {                                                                                    \
+        Hash_Map_Table table;                                                                       \
+        Map##_Entry* entries;                                                                       \
+    };                                                                                              \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    Map prefix##_create(Arena* const arena) {                                                       \
+        assert(arena != NULL);                                                                      \
+        return (Map) {                                                                              \
+            .table = hash_map_table_create(arena),                                                  \
+            .entries = NULL,                                                                        \
+        };                                                                                          \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    Map prefix##_create_buffer(                                                                     \
+        uint8_t* const buffer,                                                                      \
+        size_t const size                                                                           \
+    ) {                                                                                             \
+        void* entries = NULL;                                                                       \
+        Hash_Map_Table const table = hash_map_table_create_buffer(                                  \
+            buffer, size, sizeof(Map##_Entry), __alignof__(Map##_Entry), &entries                      \
+        );                                                                                          \
+        return (Map) {                                                                              \
+            .table = table,                                                                         \
+            .entries = entries,                                                                     \
+        };                                                                                          \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    size_t prefix##_find_index(                                                                     \
+        Map const* const map,                                                                       \
+        Key const key,                                                                              \
+        uint64_t const key_hash                                                                     \
+    ) {                                                                                             \
+        assert(map != NULL);                                                                        \
+        if (map->table.capacity == 0) {                                                             \
+            return 0;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        size_t const group_mask = map->table.capacity / HASH_MAP_GROUP_SIZE - 1;                    \
+        uint8_t const h2 = hash_map_h2(key_hash);                                                   \
+        size_t group = hash_map_h1(key_hash) & group_mask;                                          \
+                                                                                                    \
+        for (size_t step = 1; step <= group_mask + 1; step += 1) {                                  \
+            uint8_t const* const control = map->table.control + group * HASH_MAP_GROUP_SIZE;        \
+            uint32_t mask = hash_map_group_match(control, h2);                                      \
+            while (mask != 0) {                                                                     \
+                size_t const index = group * HASH_MAP_GROUP_SIZE + (size_t)__builtin_ctz(mask);     \
+                if (equal(map->entries[index].key, key)) {                                          \
+                    return index;                                                                   \
+                }                                                                                   \
+                mask &= mask - 1;                                                                   \
+            }                                                                                       \
+            if (hash_map_group_match(control, HASH_MAP_EMPTY) != 0) {                               \
+                break;                                                                              \
+            }                                                                                       \
+            group = (group + step) & group_mask;                                                    \
+        }                                                                                           \
+                                                                                                    \
+        return map->table.capacity;                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    Value* prefix##_find(                                                                           \
+        Map const* const map,                                                                       \
+        Key const key                                                                               \
+    ) {                                                                                             \
+        size_t const index = prefix##_find_index(map, key, hash(key));                              \
+        return index < map->table.capacity ? &map->entries[index].value : NULL;                     \
+    }                                                                                               \
+                                                                                                    \
+    int prefix##_resize(                                                                            \
+        Map* const map,                                                                             \
+        size_t const capacity                                                                       \
+    ) {                                                                                             \
+        assert(map != NULL);                                                                        \
+        assert(map->table.arena != NULL);                                                           \
+                                                                                                    \
+        Hash_Map_Table table = map->table;                                                          \
+        void* entries = NULL;                                                                       \
+        if (hash_map_table_allocate(                                                                \
+            &table, map->table.arena, capacity, sizeof(Map##_Entry), __alignof__(Map##_Entry), &entries \
+        ) != 0) {                                                                                   \
+            return 1;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        for (                                                                                       \
+            size_t i = hash_map_table_next_full(&map->table, 0);                                    \
+            i < map->table.capacity;                                                                \
+            i = hash_map_table_next_full(&map->table, i + 1)                                        \
+        ) {                                                                                         \
+            uint64_t const key_hash = hash(map->entries[i].key);                                    \
+            size_t const index = hash_map_table_find_available(&table, key_hash);                   \
+            table.control[index] = hash_map_h2(key_hash);                                           \
+            ((Map##_Entry*)entries)[index] = map->entries[i];                                       \
+        }                                                                                           \
+                                                                                                    \
+        map->table = table;                                                                         \
+        map->entries = entries;                                                                     \
+        return 0;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    void prefix##_rehash_in_place(Map* const map) {                                                 \
+        assert(map != NULL);                                                                        \
+        uint8_t* const control = map->table.control;                                                \
+                                                                                                    \
+        for (size_t i = 0; i < map->table.capacity; i += 1) {                                       \
+            control[i] = control[i] < HASH_MAP_EMPTY ? HASH_MAP_DELETED : HASH_MAP_EMPTY;           \
+        }                                                                                           \
+                                                                                                    \
+        for (size_t i = 0; i < map->table.capacity; i += 1) {                                       \
+            while (control[i] == HASH_MAP_DELETED) {                                                \
+                uint64_t const key_hash = hash(map->entries[i].key);                                \
+                size_t const target = hash_map_table_find_available(&map->table, key_hash);         \
+                if (target / HASH_MAP_GROUP_SIZE == i / HASH_MAP_GROUP_SIZE) {                      \
+                    control[i] = hash_map_h2(key_hash);                                             \
+                } else if (control[target] == HASH_MAP_EMPTY) {                                     \
+                    map->entries[target] = map->entries[i];                                         \
+                    control[target] = hash_map_h2(key_hash);                                        \
+                    control[i] = HASH_MAP_EMPTY;                                                    \
+                } else {                                                                            \
+                    Map##_Entry const displaced = map->entries[target];                             \
+                    map->entries[target] = map->entries[i];                                         \
+                    map->entries[i] = displaced;                                                    \
+                    control[target] = hash_map_h2(key_hash);                                        \
+                }                                                                                   \
+            }                                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        map->table.growth_left = hash_map_max_load(map->table.capacity) - map->table.count;         \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_reserve(                                                                           \
+        Map* const map,                                                                             \
+        size_t const count                                                                          \
+    ) {                                                                                             \
+        assert(map != NULL);                                                                        \
+        if (count <= map->table.count + map->table.growth_left) {                                   \
+            return 0;                                                                               \
+        }                                                                                           \
+        if (count <= hash_map_max_load(map->table.capacity)) {                                      \
+            prefix##_rehash_in_place(map);                                                          \
+            return 0;                                                                               \
+        }                                                                                           \
+        if (map->table.arena == NULL) {                                                             \
+            return 1;                                                                               \
+        }                                                                                           \
+        return prefix##_resize(map, hash_map_capacity_for(count));                                 \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_make_room(Map* const map) {                                                        \
+        assert(map != NULL);                                                                        \
+        size_t const max_load = hash_map_max_load(map->table.capacity);                             \
+        if (map->table.arena != NULL && map->table.count >= max_load / 2) {                         \
+            return prefix##_resize(map, map->table.capacity > 0                                     \
+                ? map->table.capacity * 2                                                           \
+                : HASH_MAP_GROUP_SIZE);                                                             \
+        }                                                                                           \
+        if (map->table.count < max_load) {                                                         \
+            prefix##_rehash_in_place(map);                                                          \
+            return 0;                                                                               \
+        }                                                                                           \
+        return 1;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_insert(                                                                            \
+        Map* const map,                                                                             \
+        Key const key,                                                                              \
+        Value const value                                                                           \
+    ) {                                                                                             \
+        assert(map != NULL);                                                                        \
+        uint64_t const key_hash = hash(key);                                                        \
+        size_t index = prefix##_find_index(map, key, key_hash);                                     \
+                                                                                                    \
+        if (index < map->table.capacity) {                                                          \
+            map->entries[index].value = value;                                                      \
+            return 0;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        if (map->table.capacity == 0 && prefix##_make_room(map) != 0) {                             \
+            return 1;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        index = hash_map_table_find_available(&map->table, key_hash);                               \
+        if (map->table.growth_left == 0 && map->table.control[index] == HASH_MAP_EMPTY) {           \
+            if (prefix##_make_room(map) != 0) {                                                     \
+                return 1;                                                                           \
+            }                                                                                       \
+            index = hash_map_table_find_available(&map->table, key_hash);                           \
+        }                                                                                           \
+                                                                                                    \
+        map->table.growth_left -= map->table.control[index] == HASH_MAP_EMPTY;                      \
+        map->table.control[index] = hash_map_h2(key_hash);                                          \
+        map->table.count += 1;                                                                      \
+        map->entries[index] = (Map##_Entry) { .key = key, .value = value };                         \
+        return 0;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    int prefix##_erase(                                                                             \
+        Map* const map,                                                                             \
+        Key const key                                                                               \
+    ) {                                                                                             \
+        size_t const index = prefix##_find_index(map, key, hash(key));                              \
+        if (index == map->table.capacity) {                                                         \
+            return 0;                                                                               \
+        }                                                                                           \
+        hash_map_table_erase_at(&map->table, index);                                                \
+        return 1;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_next(                                                                              \
+        Map const* const map,                                                                       \
+        size_t* const index,                                                                        \
+        Map##_Entry** const entry                                                                   \
+    ) {                                                                                             \
+        assert(map != NULL);                                                                        \
+        assert(index != NULL);                                                                      \
+        assert(entry != NULL);                                                                      \
+        size_t const found = hash_map_table_next_full(&map->table, *index);                         \
+        if (found == map->table.capacity) {                                                         \
+            *index = found;                                                                         \
+            return 0;                                                                               \
+        }                                                                                           \
+        *entry = &map->entries[found];                                                              \
+        *index = found + 1;                                                                         \
+        return 1;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    void prefix##_clear(Map* const map) {                                                           \
+        assert(map != NULL);                                                                        \
+        hash_map_table_clear(&map->table);                                                          \
+    }
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef LIBCHIMP_VECTOR_H
+#define LIBCHIMP_VECTOR_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../mem/Arena.h"
+
+// The number of elements a vector makes room for at first.
+#ifndef LIBCHIMP_VECTOR_CAPACITY
+    #define LIBCHIMP_VECTOR_CAPACITY 16
+#endif
+
+// The elements are aligned to at least this, so that SIMD loops can use aligned loads.
+#ifndef LIBCHIMP_VECTOR_ALIGNMENT
+    #define LIBCHIMP_VECTOR_ALIGNMENT 32
+#endif
+
+// Make room for at least the needed number of elements.
+// The capacity at least doubles. If the elements are the last allocation of the arena,
+// they are extended in place, otherwise they are copied to a new allocation and the
+// old one is left in the arena. The grown part is not zeroed.
+// The data and capacity are left as they were if the allocation fails.
+// Return 0 if all is good.
+// Return 1 if the arena is full.
+__attribute__((warn_unused_result))
+int vector_grow(
+    Arena* const arena,
+    void** const data,
+    size_t* const capacity,
+    size_t const length,
+    size_t const needed,
+    size_t const element_size,
+    size_t const alignment
+) {
+    assert(arena != NULL);
+    assert(data != NULL);
+    assert(capacity != NULL);
+    assert(length <= *capacity);
+    assert(element_size > 0);
+
+    if (needed <= *capacity) {
+        return 0;
+    }
+
+    size_t new_capacity = *capacity > 0 ? *capacity * 2 : LIBCHIMP_VECTOR_CAPACITY;
+    if (new_capacity < needed) {
+        new_capacity = needed;
+    }
+    if (new_capacity > SIZE_MAX / element_size) {
+        return 1;
+    }
+
+    size_t const old_size = *capacity * element_size;
+    size_t const new_size = new_capacity * element_size;
+
+    if (*data != NULL && arena_realloc_last(arena, *data, old_size, new_size) != NULL) {
+        *capacity = new_capacity;
+        return 0;
+    }
+
+    size_t const minimum_alignment = LIBCHIMP_VECTOR_ALIGNMENT;
+    void* const grown = arena_alloc_aligned_nozero(arena, new_size, alignment > minimum_alignment ? alignment : minimum_alignment);
+    if (grown == NULL) {
+        return 1;
+    }
+
+    if (length > 0) {
+        memcpy(grown, *data, length * element_size);
+    }
+
+    *data = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+// Define a growable array type specialized for the element type, with its elements in an arena.
+// The elements are contiguous and can be used directly through data and length.
+// Pointers to elements are invalidated by anything that grows the vector.
+//
+// Usage:
+//     VECTOR_DEFINE(Floats, floats, float)
+//
+//     Floats values = floats_create(&arena);
+//     if (floats_push(&values, 1.0f) != 0) {
+//         ...
+//     }
+//     for (size_t i = 0; i < values.length; i += 1) {
+//         sum += values.data[i];
+//     }
+//
+// The defined functions are:
+//     Vector prefix_create(Arena* arena)
+//     int prefix_reserve(Vector* vector, size_t capacity)            Make room for capacity elements in total
+//     int prefix_push(Vector* vector, T value)
+//     int prefix_append(Vector* vector, T const* values, size_t count)
+//     int prefix_insert(Vector* vector, size_t index, T value)       Move the later elements back by one
+//     int prefix_pop(Vector* vector, T* value)
+//     T prefix_remove(Vector* vector, size_t index)                  Move the later elements forward by one
+//     Vector_Slice prefix_slice(Vector const* vector, size_t start, size_t end)
+//     void prefix_clear(Vector* vector)
+// reserve, push, append and insert return 0 if all is good, 1 if the arena is full.
+// pop returns 0 if all is good, 1 if there was nothing to pop.
+#define VECTOR_DEFINE(Vector, prefix, T)                                                            \
+    typedef struct Vector Vector;                                                                   \
+    struct Vector {                                                                                 \
+        T* data;                                                                                    \
+        size_t length;                                                                              \
+        size_t capacity;                                                                            \
+        Arena* arena;                                                                               \
+    };                                                                                              \
+                                                                                                    \
+    typedef struct Vector##_Slice Vector##_Slice;                                                   \
+    struct Vector##_Slice {                                                                         \
+        T* data;                                                                                    \
+        size_t length;                                                                              \
+    };                                                                                              \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    Vector prefix##_create(Arena* const arena) {                                                    \
+        assert(arena != NULL);                                                                      \
+        return (Vector) {                                                                           \
+            .data = NULL,                                                                           \
+            .length = 0,                                                                            \
+            .capacity = 0,                                                                          \
+            .arena = arena,                                                                         \
+        };                                                                                          \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_reserve(                                                                           \
+        Vector* const vector,                                                                       \
+        size_t const capacity                                                                       \
+    ) {                                                                                             \
+        assert(vector != NULL);                                                                     \
+        void* data = vector->data;                                                                  \
+        int const error = vector_grow(                                                              \
+            vector->arena, &data, &vector->capacity, vector->length, capacity, sizeof(T), __alignof__(T) \
+        );                                                                                          \
+        vector->data = data;                                                                        \
+        return error;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_push(                                                                              \
+        Vector* const vector,                                                                       \
+        T const value                                                                               \
+    ) {                                                                                             \
+        assert(vector != NULL);                                                                     \
+        if (vector->length == vector->capacity && prefix##_reserve(vector, vector->length + 1) != 0) { \
+            return 1;                                                                               \
+        }                                                                                           \
+        vector->data[vector->length] = value;                                                       \
+        vector->length += 1;                                                                        \
+        return 0;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_append(                                                                            \
+        Vector* const vector,                                                                       \
+        T const* const values,                                                                      \
+        size_t const count                                                                          \
+    ) {                                                                                             \
+        assert(vector != NULL);                                                                     \
+        assert(values != NULL || count == 0);                                                       \
+        if (count > SIZE_MAX - vector->length || prefix##_reserve(vector, vector->length + count) != 0) { \
+            return 1;                                                                               \
+        }                                                                                           \
+        if (count > 0) {                                                                            \
+            memcpy(vector->data + vector->length, values, count * sizeof(T));                       \
+        }                                                                                           \
+        vector->length += count;                                                                    \
+        return 0;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_insert(                                                                            \
+        Vector* const vector,                                                                       \
+        size_t const index,                                                                         \
+        T const value                                                                               \
+    ) {                                                                                             \
+        assert(vector != NULL);                                                                     \
+        assert(index <= vector->length);                                                           \
+        if (vector->length == vector->capacity && prefix##_reserve(vector, vector->length + 1) != 0) { \
+            return 1;                                                                               \
+        }                                                                                           \
+        memmove(vector->data + index + 1, vector->data + index, (vector->length - index) * sizeof(T)); \
+        vector->data[index] = value;                                                                \
+        vector->length += 1;                                                                        \
+        return 0;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    int prefix##_pop(                                                                               \
+        Vector* const vector,                                                                       \
+        T* const value                                                                              \
+    ) {                                                                                             \
+        assert(vector != NULL);                                                                     \
+        assert(value != NULL);                                                                      \
+        if (vector->length == 0) {                                                                  \
+            return 1;                                                                               \
+        }                                                                                           \
+        vector->length -= 1;                                                                        \
+        *value = vector->data[vector->length];                                                      \
+        return 0;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    T prefix##_remove(                                                                              \
+        Vector* const vector,                                                                       \
+        size_t const index                                                                          \
+    ) {                                                                                             \
+        assert(vector != NULL);                                                                     \
+        assert(index < vector->length);                                                            \
+        T const value = vector->data[index];                                                        \
+        memmove(vector->data + index, vector->data + index + 1, (vector->length - index - 1) * sizeof(T)); \
+        vector->length -= 1;                                                                        \
+        return value;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    __attribute__((warn_unused_result))                                                             \
+    Vector##_Slice prefix##_slice(                                                                  \
+        Vector const* const vector,                                                                 \
+        size_t const start,                                                                         \
+        size_t const end                                                                            \
+    ) {                                                                                             \
+        assert(vector != NULL);                                                                     \
+        assert(start <= end);                                                                       \
+        assert(end <= vector->length);                                                              \
+        return (Vector##_Slice) {                                                                   \
+            .data = vector->data != NULL ? vector->data + start : NULL,                             \
+            .length = end - start,                                                                  \
+        };                                                                                          \
+    }                                                                                               \
+                                                                                                    \
+    void prefix##_clear(Vector* const vector) {                                                     \
+        assert(vector != NULL);                                                                     \
+        vector->length = 0;                                                                         \
+    }
+
+#endif
@@ -4,6 +4,15 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+
+#include "../scan.h"
+#include "../strings/Line_Index.h"
+
+// The size of the block buffer embedded in every file iterator.
+#ifndef LIBCHIMP_FILE_ITERATOR_BUFFER_SIZE
+    #define LIBCHIMP_FILE_ITERATOR_BUFFER_SIZE 4096
+#endif
 
 typedef struct File_Iterator_Position File_Iterator_Position;
 struct File_Iterator_Position {
@@ -12,10 +21,19 @@ struct File_Iterator_Position {
     uint64_t column;
 };
 
+// The iterator reads the file in blocks, so the position of the FILE
+// runs ahead of the iterator position.
+// With a line index, every block is indexed when it is read, so that offsets can be
+// turned into lines and columns later without tracking them byte by byte.
 typedef struct File_Iterator File_Iterator;
 struct File_Iterator {
     FILE* const file;
     File_Iterator_Position position;
+    Line_Index* line_index;
+    size_t buffer_index;
+    size_t buffer_length;
+    char is_eof;
+    char buffer[LIBCHIMP_FILE_ITERATOR_BUFFER_SIZE];
 };
 
 typedef struct File_Iterator_Result File_Iterator_Result;
@@ -31,9 +49,60 @@ File_Iterator file_iterator_create(FILE* const file) {
     return (File_Iterator) {
         .file = file,
         .position = { .offset = 0, .line = 1, .column = 1 },
+        .line_index = NULL,
+        .buffer_index = 0,
+        .buffer_length = 0,
+        .is_eof = 0,
     };
 }
 
+// Create a file iterator that adds every block it reads to the line index.
+// The index must be empty, and the file must be at its start.
+__attribute__((warn_unused_result))
+File_Iterator file_iterator_create_indexed(
+    FILE* const file,
+    Line_Index* const line_index
+) {
+    assert(line_index != NULL);
+    assert(line_index->scanned == 0);
+
+    File_Iterator iter = file_iterator_create(file);
+    iter.line_index = line_index;
+    return iter;
+}
+
+// Refill the block buffer if it has been consumed.
+// Return 0 if all is good.
+// Return EOF if there are no more bytes to read.
+__attribute__((warn_unused_result))
+int file_iterator_refill(File_Iterator* const iter) {
+    assert(iter != NULL);
+    assert(iter->file != NULL);
+    assert(iter->buffer_index <= iter->buffer_length);
+
+    if (iter->buffer_index < iter->buffer_length) {
+        return 0;
+    }
+
+    if (iter->is_eof) {
+        return EOF;
+    }
+
+    iter->buffer_length = fread(iter->buffer, 1, sizeof(iter->buffer), iter->file);
+    iter->buffer_index = 0;
+
+    if (iter->buffer_length == 0) {
+        iter->is_eof = 1;
+        return EOF;
+    }
+
+    if (iter->line_index != NULL) {
+        line_index_add(iter->line_index, iter->buffer, iter->buffer_length);
+    }
+
+    return 0;
+}
+
 // Read the next byte and increment the offset.
 __attribute__((warn_unused_result))
 File_Iterator_Result file_iterator_next(File_Iterator* const iter) {
@@ -45,9 +114,9 @@ File_Iterator_Result file_iterator_next(File_Iterator* const iter) {
         .byte = 0,
     };
 
-    int const byte = fgetc(iter->file);
-    if (byte != EOF) {
-        result.byte = byte;
+    if (file_iterator_refill(iter) != EOF) {
+        result.byte = (unsigned char)iter->buffer[iter->buffer_index];
+        iter->buffer_index += 1;
         iter->position.offset += 1;
 
         if (result.byte == '\n') {
@@ -63,7 +132,7 @@ File_Iterator_Result file_iterator_next(File_Iterator* const iter) {
 
 // Read the next byte but DO NOT increment the offset.
 __attribute__((warn_unused_result))
-File_Iterator_Result file_iterator_peek(const File_Iterator* const iter) {
+File_Iterator_Result file_iterator_peek(File_Iterator* const iter) {
     assert(iter != NULL);
     assert(iter->file != NULL);
 
@@ -72,13 +141,171 @@ File_Iterator_Result file_iterator_peek(const File_Iterator* const iter) {
         .byte = 0,
     };
 
-    char const byte = fgetc(iter->file);
-    if (byte != EOF) {
-        result.byte = byte;
-        fseek(iter->file, -1, SEEK_CUR);
+    if (file_iterator_refill(iter) != EOF) {
+        result.byte = (unsigned char)iter->buffer[iter->buffer_index];
     }
 
     return result;
 }
 
+// Consume count buffered bytes, updating the line and column in bulk.
+void file_iterator_advance(
+    File_Iterator* const iter,
+    size_t const count
+) {
+    assert(iter != NULL);
+    assert(iter->buffer_index + count <= iter->buffer_length);
+
+    char const* const start = iter->buffer + iter->buffer_index;
+    size_t const newlines = scan_count_byte(start, count, '\n');
+
+    if (newlines > 0) {
+        size_t const last_newline = scan_find_last_byte(start, count, '\n');
+        iter->position.line += newlines;
+        iter->position.column = count - last_newline;
+    } else {
+        iter->position.column += count;
+    }
+
+    iter->buffer_index += count;
+    iter->position.offset += count;
+}
+
+// Read bytes until the delimiter, the end of the file or until the buffer is full.
+// The delimiter is not consumed.
+// Return the number of bytes read.
+__attribute__((warn_unused_result))
+size_t file_iterator_read_until(
+    File_Iterator* const iter,
+    char const delimiter,
+    char* const buffer,
+    size_t const buffer_size
+) {
+    assert(iter != NULL);
+    assert(iter->file != NULL);
+    assert(buffer != NULL);
+
+    size_t n = 0;
+
+    while (n < buffer_size && file_iterator_refill(iter) != EOF) {
+        char const* const start = iter->buffer + iter->buffer_index;
+        size_t const buffered = iter->buffer_length - iter->buffer_index;
+        size_t const remaining = buffer_size - n;
+        size_t const limit = buffered < remaining ? buffered : remaining;
+        size_t const count = scan_find_byte(start, limit, delimiter);
+
+        memcpy(buffer + n, start, count);
+        file_iterator_advance(iter, count);
+        n += count;
+
+        if (count < limit) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+// Read the next line including the newline, like getline.
+// A line longer than the buffer is returned in several parts.
+// Return the number of bytes read.
+// Return 0 if no more bytes can be read.
+__attribute__((warn_unused_result))
+size_t file_iterator_read_line(
+    File_Iterator* const iter,
+    char* const buffer,
+    size_t const buffer_size
+) {
+    assert(iter != NULL);
+    assert(buffer != NULL);
+    assert(buffer_size > 0);
+
+    size_t const n = file_iterator_read_until(iter, '\n', buffer, buffer_size);
+
+    if (n < buffer_size && file_iterator_refill(iter) != EOF) {
+        buffer[n] = iter->buffer[iter->buffer_index];
+        file_iterator_advance(iter, 1);
+        return n + 1;
+    }
+
+    return n;
+}
+
+// Skip bytes as long as they belong to the byte class.
+// Return the number of bytes skipped.
+size_t file_iterator_skip_while(
+    File_Iterator* const iter,
+    Byte_Class const* const byte_class
+) {
+    assert(iter != NULL);
+    assert(byte_class != NULL);
+
+    size_t n = 0;
+
+    while (file_iterator_refill(iter) != EOF) {
+        size_t const buffered = iter->buffer_length - iter->buffer_index;
+        size_t const count = scan_skip_class(iter->buffer + iter->buffer_index, buffered, byte_class);
+
+        file_iterator_advance(iter, count);
+        n += count;
+
+        if (count < buffered) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+//
+//  OFFSET ONLY
+//
+
+// Read the next byte and increment the offset, without updating the line and column.
+// Use file_iterator_locate or file_iterator_sync_position to get them when needed.
+// The byte is 0 at the end of the file.
+__attribute__((warn_unused_result))
+int file_iterator_next_byte(File_Iterator* const iter) {
+    assert(iter != NULL);
+
+    if (file_iterator_refill(iter) == EOF) {
+        return 0;
+    }
+
+    int const byte = (unsigned char)iter->buffer[iter->buffer_index];
+    iter->buffer_index += 1;
+    iter->position.offset += 1;
+    return byte;
+}
+
+// Get the position of an offset that has been read, with the column in bytes.
+// The iterator must have been created with a line index.
+// The line and column are 0 if the index ran out of memory before the offset.
+__attribute__((warn_unused_result))
+File_Iterator_Position file_iterator_locate(
+    File_Iterator const* const iter,
+    uint64_t const offset
+) {
+    assert(iter != NULL);
+    assert(iter->line_index != NULL);
+    assert(offset <= iter->position.offset);
+
+    Line_Index_Position const found = line_index_lookup(iter->line_index, offset);
+    if (found.line == 0) {
+        return (File_Iterator_Position) { .offset = offset, .line = 0, .column = 0 };
+    }
+
+    return (File_Iterator_Position) {
+        .offset = offset,
+        .line = found.line,
+        .column = offset - found.line_start + 1,
+    };
+}
+
+// Bring the line and column up to date after offset-only reads.
+void file_iterator_sync_position(File_Iterator* const iter) {
+    assert(iter != NULL);
+    iter->position = file_iterator_locate(iter, iter->position.offset);
+}
+
 #endif
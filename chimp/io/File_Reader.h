@@ -6,13 +6,21 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "../scan.h"
+#include "../strings/parse.h"
+
+// The most bytes a number parsed from a file reader may take.
+#ifndef LIBCHIMP_FILE_READER_NUMBER_WINDOW
+    #define LIBCHIMP_FILE_READER_NUMBER_WINDOW 128
+#endif
+
 typedef struct File_Reader File_Reader;
 struct File_Reader {
     FILE* const file;
     char* buffer;
     size_t const buffer_size;
     size_t buffer_length;
-    int64_t buffer_index;
+    size_t buffer_index;
     char is_eof;
 };
 
@@ -48,18 +56,20 @@ int file_reader_refresh(File_Reader* const reader) {
     assert(reader->buffer_index <= reader->buffer_length);
     assert(reader->buffer_index <= reader->buffer_size);
 
+    if (reader->buffer_index < reader->buffer_length) {
+        return 0;
+    }
+
     if (reader->is_eof) {
         return EOF;
     }
 
-    if (reader->buffer_index >= reader->buffer_length) {
-        reader->buffer_length = fread(reader->buffer, 1, reader->buffer_size, reader->file);
-        reader->buffer_index = 0;
+    reader->buffer_length = fread(reader->buffer, 1, reader->buffer_size, reader->file);
+    reader->buffer_index = 0;
 
-        if (reader->buffer_length == 0) {
-            reader->is_eof = 1;
-            return EOF;
-        }
+    if (reader->buffer_length == 0) {
+        reader->is_eof = 1;
+        return EOF;
     }
 
     return 0;
@@ -88,8 +98,10 @@ char file_reader_read_byte(File_Reader* const reader) {
 }
 
 // Read some bytes.
-// Return a char* if all is good.
-// Return NULL if no more bytes can be read.
+// Buffered bytes are copied out first. Requests that don't fit in the
+// internal buffer are read directly into the given buffer.
+// Return the number of bytes read if all is good.
+// Return 0 if no more bytes can be read.
 __attribute__((warn_unused_result))
 size_t file_reader_read_bytes(
     File_Reader* const reader,
@@ -105,19 +117,37 @@ size_t file_reader_read_bytes(
     assert(buffer != NULL);
     assert(buffer_size > 0);
 
-    if (file_reader_refresh(reader) == EOF) {
-        return 0;
-    }
-
     size_t n = 0;
-    for (size_t i = 0; i < buffer_size; i += 1) {
-        char const byte = file_reader_read_byte(reader);
-        if (byte == EOF) {
+
+    while (n < buffer_size) {
+        size_t const remaining = buffer_size - n;
+        size_t const buffered = reader->buffer_length - reader->buffer_index;
+
+        if (buffered > 0) {
+            size_t const count = buffered < remaining ? buffered : remaining;
+            memcpy(buffer + n, reader->buffer + reader->buffer_index, count);
+            reader->buffer_index += count;
+            n += count;
+            continue;
+        }
+
+        if (reader->is_eof) {
             break;
         }
 
-        buffer[i] = byte;
-        n += 1;
+        if (remaining >= reader->buffer_size) {
+            size_t const count = fread(buffer + n, 1, remaining, reader->file);
+            if (count == 0) {
+                reader->is_eof = 1;
+                break;
+            }
+            n += count;
+            continue;
+        }
+
+        if (file_reader_refresh(reader) == EOF) {
+            break;
+        }
     }
 
     return n;
@@ -139,7 +169,10 @@ int file_reader_seek(
     assert(reader->buffer_index <= reader->buffer_length);
     assert(reader->buffer_index <= reader->buffer_size);
     assert(SEEK_SET <= origin && origin <= SEEK_END);
-    assert(fseek(reader->file, offset, origin) == 0);
+
+    int const status = fseek(reader->file, offset, origin);
+    assert(status == 0);
+    (void)status;
 
     reader->buffer_index = 0;
     reader->buffer_length = 0;
@@ -152,8 +185,8 @@ int file_reader_seek(
     return 0;
 }
 
-// Peek a byte in the reader.
-// Return the peeked char ir all is good.
+// Peek a byte in the reader without consuming it.
+// Return the peeked char if all is good.
 // Return EOF if nothing can be peeked.
 __attribute__((warn_unused_result))
 char file_reader_peek(File_Reader* const reader) {
@@ -164,20 +197,273 @@ char file_reader_peek(File_Reader* const reader) {
     assert(reader->buffer_index <= reader->buffer_length);
     assert(reader->buffer_index <= reader->buffer_size);
 
-    char const byte = file_reader_read_byte(reader);
-    if (byte == EOF) {
+    if (file_reader_refresh(reader) == EOF) {
         return EOF;
     }
 
-    reader->buffer_index = 0;
-    reader->buffer_length = 0;
-    reader->is_eof = 0;
+    return reader->buffer[reader->buffer_index];
+}
 
-    if (file_reader_refresh(reader) == EOF) {
-        return EOF;
+// Peek up to count bytes in the reader without consuming them.
+// The window points into the reader buffer and stays valid until the next read.
+// The unread bytes are moved to the front of the buffer only if the window
+// would not fit otherwise, so count can be at most buffer_size.
+// Return the number of bytes in the window, less than count only at the end of the file.
+__attribute__((warn_unused_result))
+size_t file_reader_peek_n(
+    File_Reader* const reader,
+    size_t const count,
+    char** const window
+) {
+    assert(reader != NULL);
+    assert(reader->file != NULL);
+    assert(reader->buffer != NULL);
+    assert(reader->buffer_size > 0);
+    assert(reader->buffer_index <= reader->buffer_length);
+    assert(reader->buffer_index <= reader->buffer_size);
+    assert(count <= reader->buffer_size);
+    assert(window != NULL);
+
+    size_t buffered = reader->buffer_length - reader->buffer_index;
+
+    if (buffered < count && !reader->is_eof) {
+        if (reader->buffer_index + count > reader->buffer_size) {
+            memmove(reader->buffer, reader->buffer + reader->buffer_index, buffered);
+            reader->buffer_index = 0;
+            reader->buffer_length = buffered;
+        }
+
+        while (reader->buffer_length - reader->buffer_index < count) {
+            size_t const n = fread(
+                reader->buffer + reader->buffer_length,
+                1,
+                reader->buffer_size - reader->buffer_length,
+                reader->file
+            );
+            if (n == 0) {
+                reader->is_eof = 1;
+                break;
+            }
+            reader->buffer_length += n;
+        }
+
+        buffered = reader->buffer_length - reader->buffer_index;
     }
 
-    return byte;
+    *window = reader->buffer + reader->buffer_index;
+    return buffered < count ? buffered : count;
+}
+
+// Consume bytes without copying them anywhere, e.g. after peeking them.
+// Return the number of bytes skipped, less than count only at the end of the file.
+size_t file_reader_skip(
+    File_Reader* const reader,
+    size_t const count
+) {
+    assert(reader != NULL);
+    assert(reader->file != NULL);
+    assert(reader->buffer != NULL);
+    assert(reader->buffer_size > 0);
+    assert(reader->buffer_index <= reader->buffer_length);
+    assert(reader->buffer_index <= reader->buffer_size);
+
+    size_t n = 0;
+
+    while (n < count && file_reader_refresh(reader) != EOF) {
+        size_t const buffered = reader->buffer_length - reader->buffer_index;
+        size_t const remaining = count - n;
+        size_t const skipped = buffered < remaining ? buffered : remaining;
+        reader->buffer_index += skipped;
+        n += skipped;
+    }
+
+    return n;
+}
+
+// Read bytes until the delimiter, the end of the file or until the buffer is full.
+// The delimiter is not consumed.
+// Return the number of bytes read.
+__attribute__((warn_unused_result))
+size_t file_reader_read_until(
+    File_Reader* const reader,
+    char const delimiter,
+    char* const buffer,
+    size_t const buffer_size
+) {
+    assert(reader != NULL);
+    assert(reader->file != NULL);
+    assert(reader->buffer != NULL);
+    assert(reader->buffer_size > 0);
+    assert(reader->buffer_index <= reader->buffer_length);
+    assert(reader->buffer_index <= reader->buffer_size);
+    assert(buffer != NULL);
+
+    size_t n = 0;
+
+    while (n < buffer_size && file_reader_refresh(reader) != EOF) {
+        char const* const start = reader->buffer + reader->buffer_index;
+        size_t const buffered = reader->buffer_length - reader->buffer_index;
+        size_t const remaining = buffer_size - n;
+        size_t const limit = buffered < remaining ? buffered : remaining;
+        size_t const count = scan_find_byte(start, limit, delimiter);
+
+        memcpy(buffer + n, start, count);
+        reader->buffer_index += count;
+        n += count;
+
+        if (count < limit) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+// Read the next line including the newline, like getline.
+// A line longer than the buffer is returned in several parts.
+// Return the number of bytes read.
+// Return 0 if no more bytes can be read.
+__attribute__((warn_unused_result))
+size_t file_reader_read_line(
+    File_Reader* const reader,
+    char* const buffer,
+    size_t const buffer_size
+) {
+    assert(reader != NULL);
+    assert(buffer != NULL);
+    assert(buffer_size > 0);
+
+    size_t const n = file_reader_read_until(reader, '\n', buffer, buffer_size);
+
+    if (n < buffer_size && file_reader_refresh(reader) != EOF) {
+        buffer[n] = reader->buffer[reader->buffer_index];
+        reader->buffer_index += 1;
+        return n + 1;
+    }
+
+    return n;
+}
+
+// Skip bytes as long as they belong to the byte class.
+// Return the number of bytes skipped.
+size_t file_reader_skip_while(
+    File_Reader* const reader,
+    Byte_Class const* const byte_class
+) {
+    assert(reader != NULL);
+    assert(byte_class != NULL);
+
+    size_t n = 0;
+
+    while (file_reader_refresh(reader) != EOF) {
+        size_t const buffered = reader->buffer_length - reader->buffer_index;
+        size_t const count = scan_skip_class(reader->buffer + reader->buffer_index, buffered, byte_class);
+
+        reader->buffer_index += count;
+        n += count;
+
+        if (count < buffered) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+//
+//  NUMBERS
+//
+
+// Peek a window that is big enough for any reasonable number.
+// Return the number of bytes in the window.
+__attribute__((warn_unused_result))
+size_t file_reader_peek_number(
+    File_Reader* const reader,
+    char** const window
+) {
+    size_t const count = reader->buffer_size < LIBCHIMP_FILE_READER_NUMBER_WINDOW
+        ? reader->buffer_size
+        : LIBCHIMP_FILE_READER_NUMBER_WINDOW;
+    return file_reader_peek_n(reader, count, window);
+}
+
+// Consume a parsed number from the window.
+// A number that runs to the end of a full window may continue past it, so it is not accepted.
+// The window is consumed then, like the bytes before any other offending byte.
+__attribute__((warn_unused_result))
+Parse_Error file_reader_finish_number(
+    File_Reader* const reader,
+    Parse_Error const error,
+    size_t const consumed,
+    size_t const available
+) {
+    int const is_cut = error == PARSE_ERROR_NONE && consumed == available && !reader->is_eof;
+
+    size_t const skipped = file_reader_skip(reader, consumed);
+    assert(skipped == consumed);
+    (void)skipped;
+
+    return is_cut ? PARSE_ERROR_RANGE : error;
+}
+
+// Parse a signed integer straight from the reader buffer.
+// Return PARSE_ERROR_NONE if all is good, the number is consumed.
+// On error the bytes before the offending byte are consumed.
+// Return PARSE_ERROR_RANGE also if the number fills the whole window of
+// LIBCHIMP_FILE_READER_NUMBER_WINDOW bytes, or the reader buffer if it is smaller.
+// The window is consumed then.
+__attribute__((warn_unused_result))
+Parse_Error file_reader_parse_i64(
+    File_Reader* const reader,
+    int64_t* const value
+) {
+    assert(reader != NULL);
+
+    char* window = NULL;
+    size_t const available = file_reader_peek_number(reader, &window);
+    size_t consumed = 0;
+    Parse_Error const error = parse_i64(window, available, value, &consumed);
+    return file_reader_finish_number(reader, error, consumed, available);
+}
+
+// Parse an unsigned integer straight from the reader buffer.
+// Return PARSE_ERROR_NONE if all is good, the number is consumed.
+// On error the bytes before the offending byte are consumed.
+// Return PARSE_ERROR_RANGE also if the number fills the whole window of
+// LIBCHIMP_FILE_READER_NUMBER_WINDOW bytes, or the reader buffer if it is smaller.
+// The window is consumed then.
+__attribute__((warn_unused_result))
+Parse_Error file_reader_parse_u64(
+    File_Reader* const reader,
+    uint64_t* const value
+) {
+    assert(reader != NULL);
+
+    char* window = NULL;
+    size_t const available = file_reader_peek_number(reader, &window);
+    size_t consumed = 0;
+    Parse_Error const error = parse_u64(window, available, value, &consumed);
+    return file_reader_finish_number(reader, error, consumed, available);
+}
+
+// Parse a float straight from the reader buffer.
+// Return PARSE_ERROR_NONE if all is good, the number is consumed.
+// On error the bytes before the offending byte are consumed.
+// Return PARSE_ERROR_RANGE also if the number fills the whole window of
+// LIBCHIMP_FILE_READER_NUMBER_WINDOW bytes, or the reader buffer if it is smaller.
+// The window is consumed then.
+__attribute__((warn_unused_result))
+Parse_Error file_reader_parse_f64(
+    File_Reader* const reader,
+    double* const value
+) {
+    assert(reader != NULL);
+
+    char* window = NULL;
+    size_t const available = file_reader_peek_number(reader, &window);
+    size_t consumed = 0;
+    Parse_Error const error = parse_f64(window, available, value, &consumed);
+    return file_reader_finish_number(reader, error, consumed, available);
 }
 
 #endif
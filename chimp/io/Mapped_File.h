@@ -0,0 +1,169 @@
+#ifndef LIBCHIMP_MAPPED_FILE_H
+#define LIBCHIMP_MAPPED_FILE_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "File_Reader.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/types.h>
+    #define LIBCHIMP_MAPPED_FILE_MMAP
+#endif
+
+// A read-only view of a file.
+// Regular files are memory mapped and handed out as a single block without copying.
+// Pipes, terminals and other non-seekable files fall back to the buffered File_Reader,
+// in which case the blocks are the successive refills of the reader buffer.
+//
+// Usage:
+//     Mapped_File mapped = mapped_file_create(file, buffer, sizeof(buffer));
+//     char* block = NULL;
+//     size_t length = 0;
+//     while ((length = mapped_file_next_block(&mapped, &block)) > 0) {
+//         String_Iterator iter = string_iterator_create(block, length);
+//         ...
+//     }
+//     mapped_file_destroy(&mapped);
+typedef struct Mapped_File Mapped_File;
+struct Mapped_File {
+    File_Reader reader;
+    char* data;
+    size_t length;
+    void* mapping;
+    size_t mapping_size;
+    char is_mapped;
+    char is_consumed;
+};
+
+// Try to map the file starting from its current position.
+// Return 1 if the file was mapped.
+// Return 0 if the file cannot be mapped and the buffered path must be used.
+__attribute__((warn_unused_result))
+int mapped_file_map(Mapped_File* const mapped) {
+    assert(mapped != NULL);
+    assert(mapped->reader.file != NULL);
+
+#ifdef LIBCHIMP_MAPPED_FILE_MMAP
+    int const fd = fileno(mapped->reader.file);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        return 0;
+    }
+
+    off_t const offset = ftello(mapped->reader.file);
+    if (offset < 0) {
+        return 0;
+    }
+
+    size_t const size = (size_t)status.st_size;
+    if ((size_t)offset >= size) {
+        // Nothing left to read, there's no need for a mapping.
+        mapped->data = NULL;
+        mapped->length = 0;
+        return 1;
+    }
+
+    void* const mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return 0;
+    }
+
+    // The hints are only advisory, failing them is not an error.
+    (void)madvise(mapping, size, MADV_SEQUENTIAL);
+    (void)madvise(mapping, size, MADV_WILLNEED);
+
+    mapped->mapping = mapping;
+    mapped->mapping_size = size;
+    mapped->data = (char*)mapping + offset;
+    mapped->length = size - (size_t)offset;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+// Create a mapped file.
+// The buffer is only used if the file cannot be mapped.
+__attribute__((warn_unused_result))
+Mapped_File mapped_file_create(
+    FILE* const file,
+    char* const buffer,
+    size_t const buffer_size
+) {
+    assert(file != NULL);
+    assert(buffer != NULL);
+    assert(buffer_size > 0);
+
+    Mapped_File mapped = {
+        .reader = file_reader_create(file, buffer, buffer_size),
+        .data = NULL,
+        .length = 0,
+        .mapping = NULL,
+        .mapping_size = 0,
+        .is_mapped = 0,
+        .is_consumed = 0,
+    };
+
+    mapped.is_mapped = (char)mapped_file_map(&mapped);
+    return mapped;
+}
+
+// Get the next block of file contents.
+// The block stays valid until the next call or until the mapped file is destroyed.
+// Return the length of the block if all is good.
+// Return 0 if there are no more bytes to read.
+__attribute__((warn_unused_result))
+size_t mapped_file_next_block(
+    Mapped_File* const mapped,
+    char** const block
+) {
+    assert(mapped != NULL);
+    assert(block != NULL);
+
+    if (mapped->is_mapped) {
+        if (mapped->is_consumed || mapped->length == 0) {
+            return 0;
+        }
+        mapped->is_consumed = 1;
+        *block = mapped->data;
+        return mapped->length;
+    }
+
+    File_Reader* const reader = &mapped->reader;
+    if (file_reader_refresh(reader) == EOF) {
+        return 0;
+    }
+
+    size_t const length = reader->buffer_length - reader->buffer_index;
+    *block = reader->buffer + reader->buffer_index;
+    reader->buffer_index = reader->buffer_length;
+
+    return length;
+}
+
+// Unmap the file if it was mapped.
+// The file itself is not closed.
+void mapped_file_destroy(Mapped_File* const mapped) {
+    assert(mapped != NULL);
+
+#ifdef LIBCHIMP_MAPPED_FILE_MMAP
+    if (mapped->mapping != NULL) {
+        munmap(mapped->mapping, mapped->mapping_size);
+    }
+#endif
+
+    mapped->mapping = NULL;
+    mapped->mapping_size = 0;
+    mapped->data = NULL;
+    mapped->length = 0;
+}
+
+#endif
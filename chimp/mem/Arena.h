@@ -10,6 +10,14 @@ struct Arena {
     uint8_t* const buffer;
     size_t const size;
     uint64_t offset;
+    // The highest offset since the last clear, the bytes below it may have been written.
+    uint64_t high_water;
+};
+
+// A saved offset to roll the arena back to.
+typedef struct Arena_Mark Arena_Mark;
+struct Arena_Mark {
+    uint64_t offset;
 };
 
 // Create an arena with offset set to 0.
@@ -24,21 +32,87 @@ Arena arena_create(
         .buffer = buffer,
         .size = size,
         .offset = 0,
+        .high_water = 0,
     };
 }
 
+// Align the pointer forward to the alignment if needed.
+// The alignment must be a power of two.
+__attribute__((warn_unused_result))
+uintptr_t arena_align_forward_to(
+    uintptr_t const pointer,
+    uintptr_t const alignment
+) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    uintptr_t const modulo = pointer & (alignment - 1);
+
+    if (modulo != 0) {
+        return pointer + alignment - modulo;
+    }
+
+    return pointer;
+}
+
 // Align the pointer forward if needed.
 // Reference: https://www.gingerbill.org/article/2019/02/08/memory-allocation-strategies-002/
 __attribute__((warn_unused_result))
 uintptr_t arena_align_forward(uintptr_t const pointer) {
-    uintptr_t const alignment = (uintptr_t)(2 * sizeof(void*));
-    uintptr_t const modulo = pointer & (alignment - 1);
+    return arena_align_forward_to(pointer, (uintptr_t)(2 * sizeof(void*)));
+}
 
-	if (modulo != 0) {
-        return pointer + alignment - modulo;
-	}
+// Allocate aligned memory in the arena without zeroing it.
+// The alignment must be a power of two.
+// If there's not enough memory, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* arena_alloc_aligned_nozero(
+    Arena* const arena,
+    size_t const size,
+    size_t const alignment
+) {
+    assert(arena != NULL);
+    assert(arena->buffer != NULL);
+    assert(arena->offset <= arena->size);
 
-	return pointer;
+    uintptr_t const offset_pointer = (uintptr_t)arena->buffer + (uintptr_t)arena->offset;
+    uintptr_t const aligned_offset = arena_align_forward_to(offset_pointer, alignment) - (uintptr_t)arena->buffer;
+
+    if (aligned_offset > arena->size || size > arena->size - aligned_offset) {
+        return NULL;
+    }
+
+    arena->offset = aligned_offset + size;
+    if (arena->offset > arena->high_water) {
+        arena->high_water = arena->offset;
+    }
+    return (void*)&arena->buffer[aligned_offset];
+}
+
+// Allocate aligned memory in the arena.
+// The alignment must be a power of two.
+// If there's not enough memory, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* arena_alloc_aligned(
+    Arena* const arena,
+    size_t const size,
+    size_t const alignment
+) {
+    void* const pointer = arena_alloc_aligned_nozero(arena, size, alignment);
+
+    if (pointer != NULL) {
+        memset(pointer, 0, size);
+    }
+
+    return pointer;
+}
+
+// Allocate memory in the arena without zeroing it.
+// If there's not enough memory, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* arena_alloc_nozero(
+    Arena* const arena,
+    size_t const size
+) {
+    return arena_alloc_aligned_nozero(arena, size, 2 * sizeof(void*));
 }
 
 // Allocate memory in the arena.
@@ -47,34 +121,85 @@ __attribute__((warn_unused_result))
 void* arena_alloc(
     Arena* const arena,
     size_t const size
+) {
+    return arena_alloc_aligned(arena, size, 2 * sizeof(void*));
+}
+
+// Resize the most recent allocation in place.
+// The old size must be the size the memory was allocated or last resized with.
+// The grown part is not zeroed.
+// If the pointer is not the most recent allocation or there's not enough memory,
+// the returned pointer will be NULL and the allocation is left as it was.
+__attribute__((warn_unused_result))
+void* arena_realloc_last(
+    Arena* const arena,
+    void* const pointer,
+    size_t const old_size,
+    size_t const new_size
 ) {
     assert(arena != NULL);
     assert(arena->buffer != NULL);
-    assert(arena->offset < arena->size);
+    assert(arena->offset <= arena->size);
+    assert(pointer != NULL);
 
-    void* pointer = NULL;
-
-    uintptr_t const offset_pointer = (uintptr_t)arena->buffer + (uintptr_t)arena->offset;
-    uintptr_t const aligned_offset = arena_align_forward(offset_pointer) - (uintptr_t)arena->buffer;
+    uint8_t* const bytes = pointer;
+    if (bytes < arena->buffer || bytes + old_size != arena->buffer + arena->offset) {
+        return NULL;
+    }
 
-    if (aligned_offset + size <= arena->size) {
-        pointer = (void*)&arena->buffer[aligned_offset];
-        arena->offset += size;
-        memset(pointer, 0, size);
+    size_t const start = (size_t)(bytes - arena->buffer);
+    if (new_size > arena->size - start) {
+        return NULL;
     }
 
+    arena->offset = start + new_size;
+    if (arena->offset > arena->high_water) {
+        arena->high_water = arena->offset;
+    }
     return pointer;
 }
 
-// Zero out the arena buffer entirely.
+// Zero out every part of the arena buffer that has been used since the last clear,
+// including memory given back with arena_restore, arena_reset or a shrinking arena_realloc_last.
 // Set the offset to 0.
 void arena_clear(Arena* const arena) {
     assert(arena != NULL);
     assert(arena->buffer != NULL);
-    assert(arena->offset < arena->size);
+    assert(arena->offset <= arena->high_water);
+    assert(arena->high_water <= arena->size);
 
-    memset(arena->buffer, 0, arena->size);
+    memset(arena->buffer, 0, arena->high_water);
     arena->offset = 0;
+    arena->high_water = 0;
+}
+
+// Set the offset to 0 without touching the buffer.
+// Allocations are zeroed anyway, so this is enough to reuse the arena.
+void arena_reset(Arena* const arena) {
+    assert(arena != NULL);
+    assert(arena->offset <= arena->size);
+
+    arena->offset = 0;
+}
+
+// Save the current offset of the arena.
+__attribute__((warn_unused_result))
+Arena_Mark arena_mark(Arena const* const arena) {
+    assert(arena != NULL);
+    assert(arena->offset <= arena->size);
+
+    return (Arena_Mark) { .offset = arena->offset };
+}
+
+// Free everything allocated after the mark was taken.
+void arena_restore(
+    Arena* const arena,
+    Arena_Mark const mark
+) {
+    assert(arena != NULL);
+    assert(mark.offset <= arena->offset);
+
+    arena->offset = mark.offset;
 }
 
 #endif
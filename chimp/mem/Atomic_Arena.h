@@ -0,0 +1,163 @@
+#ifndef LIBCHIMP_ATOMIC_ARENA_H
+#define LIBCHIMP_ATOMIC_ARENA_H
+
+#if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L || defined(__STDC_NO_ATOMICS__)
+    #error "Atomic_Arena.h requires C11 atomics"
+#endif
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Arena.h"
+
+// The alignment of every allocation, and the granularity of the offset.
+#define LIBCHIMP_ATOMIC_ARENA_ALIGNMENT (2 * sizeof(void*))
+
+// An arena that can be shared between threads without a lock.
+// Allocations advance the offset with a single atomic fetch-add. A failed
+// allocation still advances the offset, so the arena stays full afterwards.
+typedef struct Atomic_Arena Atomic_Arena;
+struct Atomic_Arena {
+    uint8_t* buffer;
+    size_t size;
+    _Atomic uint64_t offset;
+};
+
+// Round the size up to a multiple of the arena alignment.
+__attribute__((warn_unused_result))
+size_t atomic_arena_round_up(size_t const size) {
+    return (size + LIBCHIMP_ATOMIC_ARENA_ALIGNMENT - 1) & ~(LIBCHIMP_ATOMIC_ARENA_ALIGNMENT - 1);
+}
+
+// Create an atomic arena with offset set to 0.
+// The arena must be created before it is shared with other threads.
+__attribute__((warn_unused_result))
+Atomic_Arena atomic_arena_create(
+    uint8_t* const buffer,
+    size_t const size
+) {
+    assert(buffer != NULL);
+    assert(size > 0);
+
+    uintptr_t const aligned = arena_align_forward((uintptr_t)buffer);
+    size_t const padding = (size_t)(aligned - (uintptr_t)buffer);
+
+    return (Atomic_Arena) {
+        .buffer = (uint8_t*)aligned,
+        .size = padding < size ? size - padding : 0,
+        .offset = 0,
+    };
+}
+
+// Allocate memory in the arena without zeroing it.
+// If there's not enough memory, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* atomic_arena_alloc_nozero(
+    Atomic_Arena* const arena,
+    size_t const size
+) {
+    assert(arena != NULL);
+    assert(arena->buffer != NULL);
+
+    size_t const rounded = atomic_arena_round_up(size);
+    uint64_t const offset = atomic_fetch_add_explicit(&arena->offset, rounded, memory_order_relaxed);
+
+    if (offset > arena->size || rounded > arena->size - offset) {
+        return NULL;
+    }
+
+    return arena->buffer + offset;
+}
+
+// Allocate memory in the arena.
+// If there's not enough memory, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* atomic_arena_alloc(
+    Atomic_Arena* const arena,
+    size_t const size
+) {
+    void* const pointer = atomic_arena_alloc_nozero(arena, size);
+
+    if (pointer != NULL) {
+        memset(pointer, 0, size);
+    }
+
+    return pointer;
+}
+
+// Set the offset to 0.
+// No other thread may use the arena while it is reset.
+void atomic_arena_reset(Atomic_Arena* const arena) {
+    assert(arena != NULL);
+    atomic_store_explicit(&arena->offset, 0, memory_order_relaxed);
+}
+
+//
+//  PER-THREAD SUB-ARENAS
+//
+
+// A thread-local arena that claims chunks from a shared atomic arena,
+// so that most allocations don't touch the shared offset at all.
+typedef struct Atomic_Arena_Local Atomic_Arena_Local;
+struct Atomic_Arena_Local {
+    Atomic_Arena* shared;
+    uint8_t* buffer;
+    size_t size;
+    uint64_t offset;
+    size_t chunk_size;
+};
+
+// Create a local arena. No chunk is claimed until the first allocation.
+__attribute__((warn_unused_result))
+Atomic_Arena_Local atomic_arena_local_create(
+    Atomic_Arena* const shared,
+    size_t const chunk_size
+) {
+    assert(shared != NULL);
+    assert(chunk_size > 0);
+    return (Atomic_Arena_Local) {
+        .shared = shared,
+        .buffer = NULL,
+        .size = 0,
+        .offset = 0,
+        .chunk_size = atomic_arena_round_up(chunk_size),
+    };
+}
+
+// Allocate memory in the local arena, claiming a new chunk if needed.
+// Allocations bigger than half a chunk go to the shared arena directly.
+// If there's not enough memory, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* atomic_arena_local_alloc(
+    Atomic_Arena_Local* const local,
+    size_t const size
+) {
+    assert(local != NULL);
+    assert(local->shared != NULL);
+
+    size_t const rounded = atomic_arena_round_up(size);
+
+    if (rounded > local->chunk_size / 2) {
+        return atomic_arena_alloc(local->shared, size);
+    }
+
+    if (local->buffer == NULL || rounded > local->size - local->offset) {
+        uint8_t* const chunk = atomic_arena_alloc_nozero(local->shared, local->chunk_size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        local->buffer = chunk;
+        local->size = local->chunk_size;
+        local->offset = 0;
+    }
+
+    void* const pointer = local->buffer + local->offset;
+    local->offset += rounded;
+    memset(pointer, 0, size);
+
+    return pointer;
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef LIBCHIMP_CHAINED_ARENA_H
+#define LIBCHIMP_CHAINED_ARENA_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Arena.h"
+
+// The memory source of a chained arena.
+// free receives the same size that was passed to alloc.
+typedef struct Arena_Allocator Arena_Allocator;
+struct Arena_Allocator {
+    void* (*alloc)(void* context, size_t size);
+    void (*free)(void* context, void* pointer, size_t size);
+    void* context;
+};
+
+// A block header, followed by the memory of its arena.
+typedef struct Chained_Arena_Block Chained_Arena_Block;
+struct Chained_Arena_Block {
+    Chained_Arena_Block* previous;
+    size_t size;
+    Arena arena;
+};
+
+// An arena that grows by chaining new blocks from the allocator when the
+// current block is full. Allocations never move, and a new block is only
+// bigger than block_size if a single allocation doesn't fit otherwise.
+typedef struct Chained_Arena Chained_Arena;
+struct Chained_Arena {
+    Arena_Allocator allocator;
+    Chained_Arena_Block* current;
+    size_t block_size;
+};
+
+// A saved position to roll the arena back to.
+typedef struct Chained_Arena_Mark Chained_Arena_Mark;
+struct Chained_Arena_Mark {
+    Chained_Arena_Block* block;
+    uint64_t offset;
+};
+
+// Create a chained arena. No memory is allocated until the first allocation.
+__attribute__((warn_unused_result))
+Chained_Arena chained_arena_create(
+    Arena_Allocator const allocator,
+    size_t const block_size
+) {
+    assert(allocator.alloc != NULL);
+    assert(allocator.free != NULL);
+    assert(block_size > 0);
+    return (Chained_Arena) {
+        .allocator = allocator,
+        .current = NULL,
+        .block_size = block_size,
+    };
+}
+
+// Allocate a new block that can hold at least size bytes and make it the current block.
+// Return the block if all is good.
+// Return NULL if the allocator fails.
+__attribute__((warn_unused_result))
+Chained_Arena_Block* chained_arena_grow(
+    Chained_Arena* const arena,
+    size_t const size
+) {
+    assert(arena != NULL);
+    assert(arena->allocator.alloc != NULL);
+
+    // Leave room for aligning the first allocation of the block.
+    size_t const alignment = 2 * sizeof(void*);
+    size_t const minimum_size = size + alignment;
+    size_t const arena_size = arena->block_size > minimum_size ? arena->block_size : minimum_size;
+    size_t const block_size = sizeof(Chained_Arena_Block) + arena_size;
+
+    uint8_t* const memory = arena->allocator.alloc(arena->allocator.context, block_size);
+    if (memory == NULL) {
+        return NULL;
+    }
+
+    Chained_Arena_Block* const block = (Chained_Arena_Block*)memory;
+    Arena const block_arena = arena_create(memory + sizeof(Chained_Arena_Block), arena_size);
+
+    block->previous = arena->current;
+    block->size = block_size;
+    memcpy(&block->arena, &block_arena, sizeof(Arena));
+
+    arena->current = block;
+    return block;
+}
+
+// Allocate memory in the arena, chaining a new block if needed.
+// If the allocator fails, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* chained_arena_alloc(
+    Chained_Arena* const arena,
+    size_t const size
+) {
+    assert(arena != NULL);
+
+    if (arena->current != NULL) {
+        void* const pointer = arena_alloc(&arena->current->arena, size);
+        if (pointer != NULL) {
+            return pointer;
+        }
+    }
+
+    Chained_Arena_Block* const block = chained_arena_grow(arena, size);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    return arena_alloc(&block->arena, size);
+}
+
+// Save the current position of the arena.
+__attribute__((warn_unused_result))
+Chained_Arena_Mark chained_arena_mark(Chained_Arena const* const arena) {
+    assert(arena != NULL);
+
+    return (Chained_Arena_Mark) {
+        .block = arena->current,
+        .offset = arena->current != NULL ? arena->current->arena.offset : 0,
+    };
+}
+
+// Free everything allocated after the mark was taken.
+// Blocks chained after the mark are given back to the allocator.
+void chained_arena_restore(
+    Chained_Arena* const arena,
+    Chained_Arena_Mark const mark
+) {
+    assert(arena != NULL);
+
+    while (arena->current != mark.block) {
+        assert(arena->current != NULL);
+        Chained_Arena_Block* const block = arena->current;
+        arena->current = block->previous;
+        arena->allocator.free(arena->allocator.context, block, block->size);
+    }
+
+    if (arena->current != NULL) {
+        arena_restore(&arena->current->arena, (Arena_Mark) { .offset = mark.offset });
+    }
+}
+
+// Free everything but keep the first block for reuse.
+void chained_arena_reset(Chained_Arena* const arena) {
+    assert(arena != NULL);
+
+    while (arena->current != NULL && arena->current->previous != NULL) {
+        Chained_Arena_Block* const block = arena->current;
+        arena->current = block->previous;
+        arena->allocator.free(arena->allocator.context, block, block->size);
+    }
+
+    if (arena->current != NULL) {
+        arena_reset(&arena->current->arena);
+    }
+}
+
+// Give every block back to the allocator.
+void chained_arena_destroy(Chained_Arena* const arena) {
+    assert(arena != NULL);
+
+    Chained_Arena_Block* block = arena->current;
+    while (block != NULL) {
+        Chained_Arena_Block* const previous = block->previous;
+        arena->allocator.free(arena->allocator.context, block, block->size);
+        block = previous;
+    }
+
+    arena->current = NULL;
+}
+
+#endif
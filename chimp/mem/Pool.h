@@ -0,0 +1,375 @@
+#ifndef LIBCHIMP_POOL_H
+#define LIBCHIMP_POOL_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Arena.h"
+#include "Chained_Arena.h"
+
+// Freed objects are filled with this byte in debug builds.
+#define LIBCHIMP_POOL_POISON 0xDD
+
+// Freed objects with room for it hold this, mixed with their address, right after the
+// free list link in debug builds. A second free is caught without walking the free list.
+#define LIBCHIMP_POOL_FREED ((uintptr_t)0xF7EEDF7EEDF7EEDFull)
+
+// Report a misused object and abort in debug builds.
+#ifndef NDEBUG
+    #define LIBCHIMP_POOL_ASSERT(expr, message, object)         \
+        do if (!(expr)) {                                       \
+            fprintf(stderr, message, (void const*)(object));    \
+            abort();                                            \
+        } while (0)
+#else
+    #define LIBCHIMP_POOL_ASSERT(expr, message, object)
+#endif
+
+typedef struct Pool_Node Pool_Node;
+struct Pool_Node {
+    Pool_Node* next;
+};
+
+// A fixed-size object allocator with O(1) alloc and free.
+// Objects are carved lazily from the current block, and freed objects are kept
+// in an intrusive free list. A pool created over a chained arena takes a new
+// block from the arena when the current one is used up.
+typedef struct Pool Pool;
+struct Pool {
+    uint8_t* buffer;
+    size_t size;
+    uint64_t offset;
+    size_t object_size;
+    Pool_Node* free_list;
+    Chained_Arena* arena;
+    size_t block_size;
+    char lock;
+};
+
+// Round the object size up so that every object can hold a free list node
+// and stays pointer aligned.
+__attribute__((warn_unused_result))
+size_t pool_object_size(size_t const object_size) {
+    assert(object_size > 0);
+    size_t const alignment = sizeof(Pool_Node);
+    return (object_size + alignment - 1) & ~(alignment - 1);
+}
+
+// Create a pool carved from a caller buffer.
+__attribute__((warn_unused_result))
+Pool pool_create(
+    uint8_t* const buffer,
+    size_t const size,
+    size_t const object_size
+) {
+    assert(buffer != NULL);
+    assert(size > 0);
+
+    uintptr_t const aligned = arena_align_forward((uintptr_t)buffer);
+    size_t const padding = (size_t)(aligned - (uintptr_t)buffer);
+
+    return (Pool) {
+        .buffer = (uint8_t*)aligned,
+        .size = padding < size ? size - padding : 0,
+        .offset = 0,
+        .object_size = pool_object_size(object_size),
+        .free_list = NULL,
+        .arena = NULL,
+        .block_size = 0,
+        .lock = 0,
+    };
+}
+
+// Create a pool that takes blocks of objects_per_block objects from a chained arena.
+// No memory is taken until the first allocation.
+__attribute__((warn_unused_result))
+Pool pool_create_chained(
+    Chained_Arena* const arena,
+    size_t const object_size,
+    size_t const objects_per_block
+) {
+    assert(arena != NULL);
+    assert(objects_per_block > 0);
+
+    size_t const size = pool_object_size(object_size);
+
+    return (Pool) {
+        .buffer = NULL,
+        .size = 0,
+        .offset = 0,
+        .object_size = size,
+        .free_list = NULL,
+        .arena = arena,
+        .block_size = size * objects_per_block,
+        .lock = 0,
+    };
+}
+
+// Set or clear the freed mark of an object in debug builds.
+// Objects that only fit the free list link have no mark.
+void pool_mark(
+    Pool const* const pool,
+    void* const object,
+    int const is_freed
+) {
+#ifndef NDEBUG
+    if (pool->object_size >= 2 * sizeof(Pool_Node)) {
+        uintptr_t const mark = is_freed ? (uintptr_t)object ^ LIBCHIMP_POOL_FREED : 0;
+        memcpy((uint8_t*)object + sizeof(Pool_Node), &mark, sizeof(mark));
+    }
+#else
+    (void)pool;
+    (void)object;
+    (void)is_freed;
+#endif
+}
+
+// Check whether an object has the freed mark.
+__attribute__((warn_unused_result))
+int pool_is_marked(
+    Pool const* const pool,
+    void const* const object
+) {
+    if (pool->object_size < 2 * sizeof(Pool_Node)) {
+        return 0;
+    }
+
+    uintptr_t mark = 0;
+    memcpy(&mark, (uint8_t const*)object + sizeof(Pool_Node), sizeof(mark));
+    return mark == ((uintptr_t)object ^ LIBCHIMP_POOL_FREED);
+}
+
+// Fill a freed object with poison and mark it, leaving the free list link intact.
+void pool_poison(
+    Pool const* const pool,
+    void* const object
+) {
+#ifndef NDEBUG
+    memset((uint8_t*)object + sizeof(Pool_Node), LIBCHIMP_POOL_POISON, pool->object_size - sizeof(Pool_Node));
+#endif
+    pool_mark(pool, object, 1);
+}
+
+// Check whether a freed object is still marked and entirely poisoned.
+__attribute__((warn_unused_result))
+int pool_is_poisoned(
+    Pool const* const pool,
+    void const* const object
+) {
+    size_t start = sizeof(Pool_Node);
+    if (pool->object_size >= 2 * sizeof(Pool_Node)) {
+        if (!pool_is_marked(pool, object)) {
+            return 0;
+        }
+        start += sizeof(uintptr_t);
+    }
+
+    uint8_t const* const bytes = object;
+    for (size_t i = start; i < pool->object_size; i += 1) {
+        if (bytes[i] != LIBCHIMP_POOL_POISON) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Take an object without zeroing it.
+// If the pool is used up, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* pool_take(Pool* const pool) {
+    assert(pool != NULL);
+
+    if (pool->free_list != NULL) {
+        Pool_Node* const node = pool->free_list;
+        LIBCHIMP_POOL_ASSERT(pool_is_poisoned(pool, node), "Pool object %p was written to after it was freed\n", node);
+        pool->free_list = node->next;
+        pool_mark(pool, node, 0);
+        return node;
+    }
+
+    if (pool->buffer == NULL || pool->size - pool->offset < pool->object_size) {
+        if (pool->arena == NULL) {
+            return NULL;
+        }
+
+        uint8_t* const block = chained_arena_alloc(pool->arena, pool->block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+
+        pool->buffer = block;
+        pool->size = pool->block_size;
+        pool->offset = 0;
+    }
+
+    void* const object = pool->buffer + pool->offset;
+    pool->offset += pool->object_size;
+    pool_mark(pool, object, 0);
+    return object;
+}
+
+// Allocate a zeroed object.
+// If the pool is used up, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* pool_alloc(Pool* const pool) {
+    void* const object = pool_take(pool);
+
+    if (object != NULL) {
+        memset(object, 0, pool->object_size);
+    }
+
+    return object;
+}
+
+// Give an object back to the pool.
+void pool_free(
+    Pool* const pool,
+    void* const object
+) {
+    assert(pool != NULL);
+    assert(object != NULL);
+    LIBCHIMP_POOL_ASSERT(!pool_is_marked(pool, object), "Pool object %p was freed twice\n", object);
+
+    pool_poison(pool, object);
+
+    Pool_Node* const node = object;
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+//
+//  PER-THREAD CACHES
+//
+
+// A thread-local stash of free objects in front of a shared pool.
+// The pool is only locked when the cache refills or spills half of its capacity,
+// so threads sharing a pool must go through their caches and never call
+// pool_alloc or pool_free directly.
+typedef struct Pool_Cache Pool_Cache;
+struct Pool_Cache {
+    Pool* pool;
+    Pool_Node* free_list;
+    size_t count;
+    size_t capacity;
+};
+
+void pool_lock(Pool* const pool) {
+    while (__atomic_test_and_set(&pool->lock, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&pool->lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+void pool_unlock(Pool* const pool) {
+    __atomic_clear(&pool->lock, __ATOMIC_RELEASE);
+}
+
+// Create a cache holding at most capacity free objects.
+__attribute__((warn_unused_result))
+Pool_Cache pool_cache_create(
+    Pool* const pool,
+    size_t const capacity
+) {
+    assert(pool != NULL);
+    assert(capacity >= 2);
+    return (Pool_Cache) {
+        .pool = pool,
+        .free_list = NULL,
+        .count = 0,
+        .capacity = capacity,
+    };
+}
+
+// Allocate a zeroed object, refilling the cache from the pool if needed.
+// If the pool is used up, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* pool_cache_alloc(Pool_Cache* const cache) {
+    assert(cache != NULL);
+    assert(cache->pool != NULL);
+
+    Pool* const pool = cache->pool;
+
+    if (cache->free_list == NULL) {
+        pool_lock(pool);
+        for (size_t i = 0; i < cache->capacity / 2; i += 1) {
+            Pool_Node* const node = pool_take(pool);
+            if (node == NULL) {
+                break;
+            }
+            pool_poison(pool, node);
+            node->next = cache->free_list;
+            cache->free_list = node;
+            cache->count += 1;
+        }
+        pool_unlock(pool);
+
+        if (cache->free_list == NULL) {
+            return NULL;
+        }
+    }
+
+    Pool_Node* const node = cache->free_list;
+    LIBCHIMP_POOL_ASSERT(pool_is_poisoned(pool, node), "Pool object %p was written to after it was freed\n", node);
+    cache->free_list = node->next;
+    cache->count -= 1;
+
+    memset(node, 0, pool->object_size);
+    return node;
+}
+
+// Give every cached object back to the pool, e.g. before the thread exits.
+void pool_cache_flush(Pool_Cache* const cache) {
+    assert(cache != NULL);
+    assert(cache->pool != NULL);
+
+    Pool* const pool = cache->pool;
+
+    pool_lock(pool);
+    while (cache->free_list != NULL) {
+        Pool_Node* const node = cache->free_list;
+        cache->free_list = node->next;
+        node->next = pool->free_list;
+        pool->free_list = node;
+    }
+    pool_unlock(pool);
+
+    cache->count = 0;
+}
+
+// Give an object back to the cache, spilling half of the cache to the pool when it's full.
+void pool_cache_free(
+    Pool_Cache* const cache,
+    void* const object
+) {
+    assert(cache != NULL);
+    assert(cache->pool != NULL);
+    assert(object != NULL);
+
+    Pool* const pool = cache->pool;
+    LIBCHIMP_POOL_ASSERT(!pool_is_marked(pool, object), "Pool object %p was freed twice\n", object);
+
+    pool_poison(pool, object);
+
+    Pool_Node* const node = object;
+    node->next = cache->free_list;
+    cache->free_list = node;
+    cache->count += 1;
+
+    if (cache->count > cache->capacity) {
+        pool_lock(pool);
+        while (cache->count > cache->capacity / 2) {
+            Pool_Node* const spilled = cache->free_list;
+            cache->free_list = spilled->next;
+            spilled->next = pool->free_list;
+            pool->free_list = spilled;
+            cache->count -= 1;
+        }
+        pool_unlock(pool);
+    }
+}
+
+#endif
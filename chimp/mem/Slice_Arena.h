@@ -10,6 +10,8 @@ struct Slice_Arena {
     uint8_t* const buffer;
     size_t const size;
     uint64_t offset;
+    // The highest offset since the last clear, the bytes below it may have been written.
+    uint64_t high_water;
 };
 
 typedef struct Arena_Slice Arena_Slice;
@@ -30,6 +32,7 @@ Slice_Arena slice_arena_create(
         .buffer = buffer,
         .size = size,
         .offset = 0,
+        .high_water = 0,
     };
 }
 
@@ -56,16 +59,19 @@ Arena_Slice slice_arena_alloc(
 ) {
     assert(arena != NULL);
     assert(arena->buffer != NULL);
-    assert(arena->offset < arena->size);
+    assert(arena->offset <= arena->size);
 
     void* pointer = NULL;
 
     uintptr_t const offset_pointer = (uintptr_t)arena->buffer + (uintptr_t)arena->offset;
     uintptr_t const aligned_offset = slice_arena_align_forward(offset_pointer) - (uintptr_t)arena->buffer;
 
-    if (aligned_offset + size <= arena->size) {
+    if (aligned_offset <= arena->size && size <= arena->size - aligned_offset) {
         pointer = (void*)&arena->buffer[aligned_offset];
-        arena->offset += size;
+        arena->offset = aligned_offset + size;
+        if (arena->offset > arena->high_water) {
+            arena->high_water = arena->offset;
+        }
         memset(pointer, 0, size);
     }
 
@@ -75,14 +81,26 @@ Arena_Slice slice_arena_alloc(
     };
 }
 
-// Zero out the arena buffer entirely.
+// Zero out every part of the arena buffer that has been used since the last clear,
+// including memory given back with slice_arena_reset.
 // Set the offset to 0.
 void slice_arena_clear(Slice_Arena* const arena) {
     assert(arena != NULL);
     assert(arena->buffer != NULL);
-    assert(arena->offset < arena->size);
+    assert(arena->offset <= arena->high_water);
+    assert(arena->high_water <= arena->size);
+
+    memset(arena->buffer, 0, arena->high_water);
+    arena->offset = 0;
+    arena->high_water = 0;
+}
+
+// Set the offset to 0 without touching the buffer.
+// Allocations are zeroed anyway, so this is enough to reuse the arena.
+void slice_arena_reset(Slice_Arena* const arena) {
+    assert(arena != NULL);
+    assert(arena->offset <= arena->size);
 
-    memset(arena->buffer, 0, arena->size);
     arena->offset = 0;
 }
 
@@ -0,0 +1,197 @@
+#ifndef LIBCHIMP_VIRTUAL_ARENA_H
+#define LIBCHIMP_VIRTUAL_ARENA_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+// Memory is committed in steps of this many bytes.
+#ifndef LIBCHIMP_VIRTUAL_ARENA_COMMIT_SIZE
+    #define LIBCHIMP_VIRTUAL_ARENA_COMMIT_SIZE (64 * 1024)
+#endif
+
+// An arena that reserves a large range of address space up front and
+// commits pages as the offset grows. Allocations never move, and only the
+// used part of the range takes up memory.
+typedef struct Virtual_Arena Virtual_Arena;
+struct Virtual_Arena {
+    uint8_t* buffer;
+    size_t reserved;
+    size_t committed;
+    uint64_t offset;
+};
+
+// A saved offset to roll the arena back to.
+typedef struct Virtual_Arena_Mark Virtual_Arena_Mark;
+struct Virtual_Arena_Mark {
+    uint64_t offset;
+};
+
+// Get the size of a memory page.
+__attribute__((warn_unused_result))
+size_t virtual_arena_page_size(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// Round the size up to a multiple of the alignment, which must be a power of two.
+__attribute__((warn_unused_result))
+size_t virtual_arena_round_up(
+    size_t const size,
+    size_t const alignment
+) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// Reserve address space for the arena. Nothing is committed yet.
+// If the reservation fails, the buffer will be NULL.
+__attribute__((warn_unused_result))
+Virtual_Arena virtual_arena_create(size_t const reserve_size) {
+    assert(reserve_size > 0);
+
+    size_t const size = virtual_arena_round_up(reserve_size, virtual_arena_page_size());
+
+#ifdef _WIN32
+    void* buffer = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    #ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+    #endif
+    void* buffer = mmap(NULL, size, PROT_NONE, flags, -1, 0);
+    if (buffer == MAP_FAILED) {
+        buffer = NULL;
+    }
+#endif
+
+    return (Virtual_Arena) {
+        .buffer = buffer,
+        .reserved = buffer != NULL ? size : 0,
+        .committed = 0,
+        .offset = 0,
+    };
+}
+
+// Commit memory so that at least size bytes from the start of the range are usable.
+// Return 0 if all is good.
+// Return 1 if the memory could not be committed.
+__attribute__((warn_unused_result))
+int virtual_arena_commit(
+    Virtual_Arena* const arena,
+    size_t const size
+) {
+    assert(arena != NULL);
+    assert(arena->buffer != NULL);
+    assert(size <= arena->reserved);
+
+    if (size <= arena->committed) {
+        return 0;
+    }
+
+    size_t committed = virtual_arena_round_up(size, LIBCHIMP_VIRTUAL_ARENA_COMMIT_SIZE);
+    if (committed > arena->reserved) {
+        committed = arena->reserved;
+    }
+
+    uint8_t* const start = arena->buffer + arena->committed;
+    size_t const length = committed - arena->committed;
+
+#ifdef _WIN32
+    if (VirtualAlloc(start, length, MEM_COMMIT, PAGE_READWRITE) == NULL) {
+        return 1;
+    }
+#else
+    if (mprotect(start, length, PROT_READ | PROT_WRITE) != 0) {
+        return 1;
+    }
+#endif
+
+    arena->committed = committed;
+    return 0;
+}
+
+// Allocate memory in the arena, committing more pages if needed.
+// If the reservation is exhausted or committing fails, the pointer will be NULL.
+__attribute__((warn_unused_result))
+void* virtual_arena_alloc(
+    Virtual_Arena* const arena,
+    size_t const size
+) {
+    assert(arena != NULL);
+    assert(arena->buffer != NULL);
+    assert(arena->offset <= arena->reserved);
+
+    size_t const alignment = 2 * sizeof(void*);
+    size_t const aligned_offset = virtual_arena_round_up(arena->offset, alignment);
+
+    if (aligned_offset > arena->reserved || size > arena->reserved - aligned_offset) {
+        return NULL;
+    }
+
+    if (virtual_arena_commit(arena, aligned_offset + size) != 0) {
+        return NULL;
+    }
+
+    void* const pointer = arena->buffer + aligned_offset;
+    arena->offset = aligned_offset + size;
+    memset(pointer, 0, size);
+
+    return pointer;
+}
+
+// Set the offset to 0 without touching the memory, like arena_reset.
+// Allocations are zeroed anyway, and the committed memory is kept for reuse.
+void virtual_arena_reset(Virtual_Arena* const arena) {
+    assert(arena != NULL);
+    arena->offset = 0;
+}
+
+// Save the current offset of the arena.
+__attribute__((warn_unused_result))
+Virtual_Arena_Mark virtual_arena_mark(Virtual_Arena const* const arena) {
+    assert(arena != NULL);
+    return (Virtual_Arena_Mark) { .offset = arena->offset };
+}
+
+// Free everything allocated after the mark was taken.
+// The committed memory is kept for reuse.
+void virtual_arena_restore(
+    Virtual_Arena* const arena,
+    Virtual_Arena_Mark const mark
+) {
+    assert(arena != NULL);
+    assert(mark.offset <= arena->offset);
+    arena->offset = mark.offset;
+}
+
+// Release the whole reserved range.
+void virtual_arena_destroy(Virtual_Arena* const arena) {
+    assert(arena != NULL);
+
+    if (arena->buffer != NULL) {
+#ifdef _WIN32
+        VirtualFree(arena->buffer, 0, MEM_RELEASE);
+#else
+        munmap(arena->buffer, arena->reserved);
+#endif
+    }
+
+    arena->buffer = NULL;
+    arena->reserved = 0;
+    arena->committed = 0;
+    arena->offset = 0;
+}
+
+#endif
@@ -0,0 +1,584 @@
+/*
+    Bulk byte scanning over buffers.
+
+    The scan_* functions pick the widest implementation the CPU supports at runtime:
+    AVX2, then SSE2, then a portable scalar loop. The individual implementations are
+    also exposed so that they can be tested and benchmarked against each other.
+
+    Define LIBCHIMP_SCAN_SCALAR to always use the scalar implementations.
+*/
+
+#ifndef LIBCHIMP_SCAN_H
+#define LIBCHIMP_SCAN_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && !defined(LIBCHIMP_SCAN_SCALAR)
+    #include <immintrin.h>
+    #define LIBCHIMP_SCAN_X86
+#endif
+
+//
+//  BYTE CLASSES
+//
+
+typedef struct Byte_Class Byte_Class;
+struct Byte_Class {
+    uint8_t bits[32];
+};
+
+// Create a byte class from the bytes of a NUL-terminated string.
+__attribute__((warn_unused_result))
+Byte_Class byte_class_create(char const* const bytes) {
+    assert(bytes != NULL);
+
+    Byte_Class byte_class = {{0}};
+    for (size_t i = 0; bytes[i] != 0; i += 1) {
+        uint8_t const byte = (uint8_t)bytes[i];
+        byte_class.bits[byte >> 3] |= (uint8_t)(1 << (byte & 7));
+    }
+
+    return byte_class;
+}
+
+// Check whether the byte belongs to the class.
+__attribute__((warn_unused_result))
+int byte_class_contains(
+    Byte_Class const* const byte_class,
+    char const byte
+) {
+    uint8_t const value = (uint8_t)byte;
+    return (byte_class->bits[value >> 3] >> (value & 7)) & 1;
+}
+
+//
+//  SCALAR
+//
+
+__attribute__((warn_unused_result))
+size_t scan_find_byte_scalar(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    for (size_t i = 0; i < length; i += 1) {
+        if (data[i] == byte) {
+            return i;
+        }
+    }
+    return length;
+}
+
+__attribute__((warn_unused_result))
+size_t scan_count_byte_scalar(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i += 1) {
+        count += data[i] == byte;
+    }
+    return count;
+}
+
+// The most bytes scan_find_any looks for at once.
+#define LIBCHIMP_SCAN_ANY_MAX 8
+
+__attribute__((warn_unused_result))
+size_t scan_find_any_scalar(
+    char const* const data,
+    size_t const length,
+    char const* const bytes,
+    size_t const count
+) {
+    for (size_t i = 0; i < length; i += 1) {
+        for (size_t k = 0; k < count; k += 1) {
+            if (data[i] == bytes[k]) {
+                return i;
+            }
+        }
+    }
+    return length;
+}
+
+// Check whether the byte must be escaped in a JSON string.
+__attribute__((warn_unused_result))
+int scan_is_json_escape(char const byte) {
+    return (uint8_t)byte < 0x20 || byte == '"' || byte == '\\';
+}
+
+__attribute__((warn_unused_result))
+size_t scan_find_json_escape_scalar(
+    char const* const data,
+    size_t const length
+) {
+    for (size_t i = 0; i < length; i += 1) {
+        if (scan_is_json_escape(data[i])) {
+            return i;
+        }
+    }
+    return length;
+}
+
+__attribute__((warn_unused_result))
+size_t scan_find_substring_scalar(
+    char const* const data,
+    size_t const length,
+    char const* const needle,
+    size_t const needle_length
+) {
+    if (needle_length > length) {
+        return length;
+    }
+    for (size_t i = 0; i + needle_length <= length; i += 1) {
+        if (memcmp(data + i, needle, needle_length) == 0) {
+            return i;
+        }
+    }
+    return length;
+}
+
+//
+//  SSE2 AND AVX2
+//
+
+#ifdef LIBCHIMP_SCAN_X86
+
+__attribute__((warn_unused_result))
+size_t scan_find_byte_sse2(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    __m128i const needle = _mm_set1_epi8(byte);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i const chunk = _mm_loadu_si128((__m128i const*)(data + i));
+        int const mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+
+    return i + scan_find_byte_scalar(data + i, length - i, byte);
+}
+
+__attribute__((warn_unused_result))
+size_t scan_count_byte_sse2(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    __m128i const needle = _mm_set1_epi8(byte);
+    __m128i const zero = _mm_setzero_si128();
+    size_t blocks = length / 16;
+    size_t count = 0;
+    size_t i = 0;
+
+    while (blocks > 0) {
+        // The per-lane byte counters overflow after 255 blocks.
+        size_t const n = blocks < 255 ? blocks : 255;
+        __m128i counters = zero;
+
+        for (size_t b = 0; b < n; b += 1, i += 16) {
+            __m128i const chunk = _mm_loadu_si128((__m128i const*)(data + i));
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(chunk, needle));
+        }
+
+        __m128i const sums = _mm_sad_epu8(counters, zero);
+        count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_extract_epi16(sums, 4);
+        blocks -= n;
+    }
+
+    return count + scan_count_byte_scalar(data + i, length - i, byte);
+}
+
+__attribute__((warn_unused_result, target("avx2")))
+size_t scan_find_byte_avx2(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    __m256i const needle = _mm256_set1_epi8(byte);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i const chunk = _mm256_loadu_si256((__m256i const*)(data + i));
+        unsigned const mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return i + scan_find_byte_sse2(data + i, length - i, byte);
+}
+
+__attribute__((warn_unused_result, target("avx2")))
+size_t scan_count_byte_avx2(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    __m256i const needle = _mm256_set1_epi8(byte);
+    __m256i const zero = _mm256_setzero_si256();
+    size_t blocks = length / 32;
+    size_t count = 0;
+    size_t i = 0;
+
+    while (blocks > 0) {
+        // The per-lane byte counters overflow after 255 blocks.
+        size_t const n = blocks < 255 ? blocks : 255;
+        __m256i counters = zero;
+
+        for (size_t b = 0; b < n; b += 1, i += 32) {
+            __m256i const chunk = _mm256_loadu_si256((__m256i const*)(data + i));
+            counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(chunk, needle));
+        }
+
+        uint64_t sums[4];
+        _mm256_storeu_si256((__m256i*)sums, _mm256_sad_epu8(counters, zero));
+        count += (size_t)(sums[0] + sums[1] + sums[2] + sums[3]);
+        blocks -= n;
+    }
+
+    return count + scan_count_byte_sse2(data + i, length - i, byte);
+}
+
+__attribute__((warn_unused_result))
+size_t scan_find_any_sse2(
+    char const* const data,
+    size_t const length,
+    char const* const bytes,
+    size_t const count
+) {
+    __m128i needles[LIBCHIMP_SCAN_ANY_MAX];
+    for (size_t k = 0; k < count; k += 1) {
+        needles[k] = _mm_set1_epi8(bytes[k]);
+    }
+
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i const chunk = _mm_loadu_si128((__m128i const*)(data + i));
+        __m128i hits = _mm_setzero_si128();
+        for (size_t k = 0; k < count; k += 1) {
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[k]));
+        }
+        int const mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+
+    return i + scan_find_any_scalar(data + i, length - i, bytes, count);
+}
+
+__attribute__((warn_unused_result))
+size_t scan_find_json_escape_sse2(
+    char const* const data,
+    size_t const length
+) {
+    __m128i const quote = _mm_set1_epi8('"');
+    __m128i const backslash = _mm_set1_epi8('\\');
+    __m128i const control = _mm_set1_epi8(0x1F);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i const chunk = _mm_loadu_si128((__m128i const*)(data + i));
+        // A byte is a control character when max(byte, 0x1F) is still 0x1F.
+        __m128i const hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)
+        );
+        int const mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+
+    return i + scan_find_json_escape_scalar(data + i, length - i);
+}
+
+__attribute__((warn_unused_result, target("avx2")))
+size_t scan_find_any_avx2(
+    char const* const data,
+    size_t const length,
+    char const* const bytes,
+    size_t const count
+) {
+    __m256i needles[LIBCHIMP_SCAN_ANY_MAX];
+    for (size_t k = 0; k < count; k += 1) {
+        needles[k] = _mm256_set1_epi8(bytes[k]);
+    }
+
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i const chunk = _mm256_loadu_si256((__m256i const*)(data + i));
+        __m256i hits = _mm256_setzero_si256();
+        for (size_t k = 0; k < count; k += 1) {
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, needles[k]));
+        }
+        unsigned const mask = (unsigned)_mm256_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return i + scan_find_any_sse2(data + i, length - i, bytes, count);
+}
+
+__attribute__((warn_unused_result, target("avx2")))
+size_t scan_find_json_escape_avx2(
+    char const* const data,
+    size_t const length
+) {
+    __m256i const quote = _mm256_set1_epi8('"');
+    __m256i const backslash = _mm256_set1_epi8('\\');
+    __m256i const control = _mm256_set1_epi8(0x1F);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i const chunk = _mm256_loadu_si256((__m256i const*)(data + i));
+        __m256i const hits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control), control)
+        );
+        unsigned const mask = (unsigned)_mm256_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return i + scan_find_json_escape_sse2(data + i, length - i);
+}
+
+// Compare the first and the last byte of the needle at 16 positions at once,
+// and only check the candidates where both match with memcmp.
+__attribute__((warn_unused_result))
+size_t scan_find_substring_sse2(
+    char const* const data,
+    size_t const length,
+    char const* const needle,
+    size_t const needle_length
+) {
+    if (needle_length == 0) {
+        return 0;
+    }
+    if (needle_length > length) {
+        return length;
+    }
+
+    __m128i const first = _mm_set1_epi8(needle[0]);
+    __m128i const last = _mm_set1_epi8(needle[needle_length - 1]);
+    size_t i = 0;
+
+    for (; i + needle_length - 1 + 16 <= length; i += 16) {
+        __m128i const block_first = _mm_loadu_si128((__m128i const*)(data + i));
+        __m128i const block_last = _mm_loadu_si128((__m128i const*)(data + i + needle_length - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))
+        );
+
+        while (mask != 0) {
+            size_t const candidate = i + (size_t)__builtin_ctz(mask);
+            if (memcmp(data + candidate, needle, needle_length) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    size_t const rest = scan_find_substring_scalar(data + i, length - i, needle, needle_length);
+    return rest == length - i ? length : i + rest;
+}
+
+__attribute__((warn_unused_result, target("avx2")))
+size_t scan_find_substring_avx2(
+    char const* const data,
+    size_t const length,
+    char const* const needle,
+    size_t const needle_length
+) {
+    if (needle_length == 0) {
+        return 0;
+    }
+    if (needle_length > length) {
+        return length;
+    }
+
+    __m256i const first = _mm256_set1_epi8(needle[0]);
+    __m256i const last = _mm256_set1_epi8(needle[needle_length - 1]);
+    size_t i = 0;
+
+    for (; i + needle_length - 1 + 32 <= length; i += 32) {
+        __m256i const block_first = _mm256_loadu_si256((__m256i const*)(data + i));
+        __m256i const block_last = _mm256_loadu_si256((__m256i const*)(data + i + needle_length - 1));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last))
+        );
+
+        while (mask != 0) {
+            size_t const candidate = i + (size_t)__builtin_ctz(mask);
+            if (memcmp(data + candidate, needle, needle_length) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    size_t const rest = scan_find_substring_sse2(data + i, length - i, needle, needle_length);
+    return rest == length - i ? length : i + rest;
+}
+
+// Check whether the CPU supports AVX2.
+__attribute__((warn_unused_result))
+int scan_has_avx2(void) {
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+//
+//  DISPATCH
+//
+
+// Find the first occurrence of the byte.
+// Return the index of the byte, or length if it was not found.
+__attribute__((warn_unused_result))
+size_t scan_find_byte(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    assert(data != NULL || length == 0);
+#ifdef LIBCHIMP_SCAN_X86
+    if (scan_has_avx2()) {
+        return scan_find_byte_avx2(data, length, byte);
+    }
+    return scan_find_byte_sse2(data, length, byte);
+#else
+    return scan_find_byte_scalar(data, length, byte);
+#endif
+}
+
+// Count the occurrences of the byte.
+__attribute__((warn_unused_result))
+size_t scan_count_byte(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    assert(data != NULL || length == 0);
+#ifdef LIBCHIMP_SCAN_X86
+    if (scan_has_avx2()) {
+        return scan_count_byte_avx2(data, length, byte);
+    }
+    return scan_count_byte_sse2(data, length, byte);
+#else
+    return scan_count_byte_scalar(data, length, byte);
+#endif
+}
+
+// Find the first byte that is any of the count bytes, at most LIBCHIMP_SCAN_ANY_MAX.
+// Return the index of the byte, or length if none was found.
+__attribute__((warn_unused_result))
+size_t scan_find_any(
+    char const* const data,
+    size_t const length,
+    char const* const bytes,
+    size_t const count
+) {
+    assert(data != NULL || length == 0);
+    assert(bytes != NULL);
+    assert(count <= LIBCHIMP_SCAN_ANY_MAX);
+#ifdef LIBCHIMP_SCAN_X86
+    if (scan_has_avx2()) {
+        return scan_find_any_avx2(data, length, bytes, count);
+    }
+    return scan_find_any_sse2(data, length, bytes, count);
+#else
+    return scan_find_any_scalar(data, length, bytes, count);
+#endif
+}
+
+// Find the first byte that must be escaped in a JSON string:
+// a quote, a backslash or a control character.
+// Return the index of the byte, or length if none was found.
+__attribute__((warn_unused_result))
+size_t scan_find_json_escape(
+    char const* const data,
+    size_t const length
+) {
+    assert(data != NULL || length == 0);
+#ifdef LIBCHIMP_SCAN_X86
+    if (scan_has_avx2()) {
+        return scan_find_json_escape_avx2(data, length);
+    }
+    return scan_find_json_escape_sse2(data, length);
+#else
+    return scan_find_json_escape_scalar(data, length);
+#endif
+}
+
+// Find the first occurrence of the needle.
+// An empty needle is found at index 0.
+// Return the index of the needle, or length if it was not found.
+__attribute__((warn_unused_result))
+size_t scan_find_substring(
+    char const* const data,
+    size_t const length,
+    char const* const needle,
+    size_t const needle_length
+) {
+    assert(data != NULL || length == 0);
+    assert(needle != NULL || needle_length == 0);
+#ifdef LIBCHIMP_SCAN_X86
+    if (scan_has_avx2()) {
+        return scan_find_substring_avx2(data, length, needle, needle_length);
+    }
+    return scan_find_substring_sse2(data, length, needle, needle_length);
+#else
+    return scan_find_substring_scalar(data, length, needle, needle_length);
+#endif
+}
+
+// Find the last occurrence of the byte.
+// This is meant for short tails, e.g. the bytes after the last newline of a block.
+// Return the index of the byte, or length if it was not found.
+__attribute__((warn_unused_result))
+size_t scan_find_last_byte(
+    char const* const data,
+    size_t const length,
+    char const byte
+) {
+    assert(data != NULL || length == 0);
+    for (size_t i = length; i > 0; i -= 1) {
+        if (data[i - 1] == byte) {
+            return i - 1;
+        }
+    }
+    return length;
+}
+
+// Count the leading bytes that belong to the class.
+__attribute__((warn_unused_result))
+size_t scan_skip_class(
+    char const* const data,
+    size_t const length,
+    Byte_Class const* const byte_class
+) {
+    assert(data != NULL || length == 0);
+    assert(byte_class != NULL);
+    size_t i = 0;
+    while (i < length && byte_class_contains(byte_class, data[i])) {
+        i += 1;
+    }
+    return i;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef LIBCHIMP_LINE_INDEX_H
+#define LIBCHIMP_LINE_INDEX_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../mem/Arena.h"
+#include "../scan.h"
+
+// The number of newline offsets the index makes room for at first.
+#ifndef LIBCHIMP_LINE_INDEX_CAPACITY
+    #define LIBCHIMP_LINE_INDEX_CAPACITY 64
+#endif
+
+// The offsets of the newlines in a text, to turn byte offsets into lines and columns
+// only when they are needed, e.g. for error messages.
+// Bytes are added in order, a block at a time, and the newlines are found with a
+// SIMD scan. A lookup is a binary search over the newline offsets.
+// The offsets live in an arena. If the arena runs out, the index stops growing and
+// offsets past the indexed part can't be looked up.
+typedef struct Line_Index Line_Index;
+struct Line_Index {
+    Arena* arena;
+    uint64_t* newlines;
+    size_t count;
+    size_t capacity;
+    uint64_t scanned;
+    char is_full;
+};
+
+typedef struct Line_Index_Position Line_Index_Position;
+struct Line_Index_Position {
+    uint64_t line;
+    uint64_t line_start;
+};
+
+// Create an empty line index. Nothing is allocated until the first newline.
+__attribute__((warn_unused_result))
+Line_Index line_index_create(Arena* const arena) {
+    assert(arena != NULL);
+    return (Line_Index) {
+        .arena = arena,
+        .newlines = NULL,
+        .count = 0,
+        .capacity = 0,
+        .scanned = 0,
+        .is_full = 0,
+    };
+}
+
+// Make room for one more newline offset.
+// Return 0 if all is good.
+// Return 1 if the arena is full.
+__attribute__((warn_unused_result))
+int line_index_grow(Line_Index* const index) {
+    assert(index != NULL);
+
+    size_t const capacity = index->capacity > 0 ? index->capacity * 2 : LIBCHIMP_LINE_INDEX_CAPACITY;
+    size_t const old_size = index->capacity * sizeof(uint64_t);
+    size_t const new_size = capacity * sizeof(uint64_t);
+
+    if (index->newlines != NULL && arena_realloc_last(index->arena, index->newlines, old_size, new_size) != NULL) {
+        index->capacity = capacity;
+        return 0;
+    }
+
+    uint64_t* const newlines = arena_alloc_nozero(index->arena, new_size);
+    if (newlines == NULL) {
+        return 1;
+    }
+
+    if (index->count > 0) {
+        memcpy(newlines, index->newlines, index->count * sizeof(uint64_t));
+    }
+
+    index->newlines = newlines;
+    index->capacity = capacity;
+    return 0;
+}
+
+// Index the next length bytes of the text, which start at the scanned offset.
+// Return 0 if all is good.
+// Return 1 if the arena is full, the bytes after the last newline that fit are not indexed.
+int line_index_add(
+    Line_Index* const index,
+    char const* const data,
+    size_t const length
+) {
+    assert(index != NULL);
+    assert(data != NULL || length == 0);
+
+    if (index->is_full) {
+        return 1;
+    }
+
+    size_t i = 0;
+
+    while (i < length) {
+        size_t const found = i + scan_find_byte(data + i, length - i, '\n');
+        if (found == length) {
+            break;
+        }
+
+        if (index->count == index->capacity && line_index_grow(index)) {
+            index->scanned += found;
+            index->is_full = 1;
+            return 1;
+        }
+
+        index->newlines[index->count] = index->scanned + found;
+        index->count += 1;
+        i = found + 1;
+    }
+
+    index->scanned += length;
+    return 0;
+}
+
+// Find the line that the offset is on, and the offset where that line starts.
+// A newline belongs to the line it ends.
+// Return a line of 0 if the offset is past the indexed bytes.
+__attribute__((warn_unused_result))
+Line_Index_Position line_index_lookup(
+    Line_Index const* const index,
+    uint64_t const offset
+) {
+    assert(index != NULL);
+
+    if (offset > index->scanned) {
+        return (Line_Index_Position) { .line = 0, .line_start = 0 };
+    }
+
+    // Count the newlines before the offset.
+    size_t low = 0;
+    size_t high = index->count;
+    while (low < high) {
+        size_t const middle = low + (high - low) / 2;
+        if (index->newlines[middle] < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return (Line_Index_Position) {
+        .line = low + 1,
+        .line_start = low > 0 ? index->newlines[low - 1] + 1 : 0,
+    };
+}
+
+#endif
@@ -0,0 +1,246 @@
+#ifndef LIBCHIMP_STR_H
+#define LIBCHIMP_STR_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../scan.h"
+
+// A non-owning view of bytes.
+// The bytes are not NUL-terminated, so the length is always known without strlen.
+typedef struct Str Str;
+struct Str {
+    char const* data;
+    size_t length;
+};
+
+// Create a Str from a string literal without calling strlen.
+#define STR_LITERAL(literal) ((Str) { .data = (literal), .length = sizeof(literal) - 1 })
+
+// Create a Str.
+__attribute__((warn_unused_result))
+Str str_create(
+    char const* const data,
+    size_t const length
+) {
+    assert(data != NULL || length == 0);
+    return (Str) {
+        .data = data,
+        .length = length,
+    };
+}
+
+// Create a Str from a NUL-terminated string, measuring it once.
+__attribute__((warn_unused_result))
+Str str_from_cstring(char const* const string) {
+    assert(string != NULL);
+    return str_create(string, strlen(string));
+}
+
+// Get the bytes in [start, end).
+__attribute__((warn_unused_result))
+Str str_slice(
+    Str const str,
+    size_t const start,
+    size_t const end
+) {
+    assert(start <= end);
+    assert(end <= str.length);
+    return str_create(str.data + start, end - start);
+}
+
+// Find the first occurrence of the byte.
+// Return the index of the byte, or the length of the Str if it was not found.
+__attribute__((warn_unused_result))
+size_t str_find_byte(
+    Str const str,
+    char const byte
+) {
+    return scan_find_byte(str.data, str.length, byte);
+}
+
+// Find the first byte that is any of the given bytes, at most LIBCHIMP_SCAN_ANY_MAX.
+// Return the index of the byte, or the length of the Str if none was found.
+__attribute__((warn_unused_result))
+size_t str_find_any(
+    Str const str,
+    Str const bytes
+) {
+    return scan_find_any(str.data, str.length, bytes.data, bytes.length);
+}
+
+// Find the first occurrence of the needle.
+// Return the index of the needle, or the length of the Str if it was not found.
+__attribute__((warn_unused_result))
+size_t str_find(
+    Str const str,
+    Str const needle
+) {
+    if (needle.length == 1) {
+        return scan_find_byte(str.data, str.length, needle.data[0]);
+    }
+    return scan_find_substring(str.data, str.length, needle.data, needle.length);
+}
+
+// Check whether the Str contains the needle.
+__attribute__((warn_unused_result))
+int str_contains(
+    Str const str,
+    Str const needle
+) {
+    return needle.length == 0 || str_find(str, needle) < str.length;
+}
+
+// Compare the bytes like memcmp, a shorter prefix comes first.
+// Return a negative number, 0 or a positive number.
+__attribute__((warn_unused_result))
+int str_compare(
+    Str const first,
+    Str const second
+) {
+    size_t const length = first.length < second.length ? first.length : second.length;
+    int const result = length > 0 ? memcmp(first.data, second.data, length) : 0;
+
+    if (result != 0) {
+        return result;
+    }
+
+    return (first.length > second.length) - (first.length < second.length);
+}
+
+// Check whether the bytes are equal.
+__attribute__((warn_unused_result))
+int str_equal(
+    Str const first,
+    Str const second
+) {
+    return first.length == second.length
+        && (first.length == 0 || memcmp(first.data, second.data, first.length) == 0);
+}
+
+__attribute__((warn_unused_result))
+int str_starts_with(
+    Str const str,
+    Str const prefix
+) {
+    return prefix.length <= str.length && str_equal(str_create(str.data, prefix.length), prefix);
+}
+
+__attribute__((warn_unused_result))
+int str_ends_with(
+    Str const str,
+    Str const suffix
+) {
+    return suffix.length <= str.length
+        && str_equal(str_create(str.data + str.length - suffix.length, suffix.length), suffix);
+}
+
+// Check whether the byte is ASCII whitespace.
+__attribute__((warn_unused_result))
+int str_is_space(char const byte) {
+    return byte == ' ' || ('\t' <= byte && byte <= '\r');
+}
+
+// Remove leading whitespace.
+// Whitespace is only looked for at the edges, so this doesn't need a wide scan.
+__attribute__((warn_unused_result))
+Str str_trim_left(Str const str) {
+    size_t start = 0;
+    while (start < str.length && str_is_space(str.data[start])) {
+        start += 1;
+    }
+    return str_create(str.data + start, str.length - start);
+}
+
+// Remove trailing whitespace.
+__attribute__((warn_unused_result))
+Str str_trim_right(Str const str) {
+    size_t end = str.length;
+    while (end > 0 && str_is_space(str.data[end - 1])) {
+        end -= 1;
+    }
+    return str_create(str.data, end);
+}
+
+// Remove leading and trailing whitespace.
+__attribute__((warn_unused_result))
+Str str_trim(Str const str) {
+    return str_trim_right(str_trim_left(str));
+}
+
+// Split at the first occurrence of the delimiter.
+// Return 1 if the delimiter was found, the parts before and after it are set.
+// Return 0 if it was not found, the parts are left as they were.
+__attribute__((warn_unused_result))
+int str_split_once(
+    Str const str,
+    char const delimiter,
+    Str* const before,
+    Str* const after
+) {
+    assert(before != NULL);
+    assert(after != NULL);
+
+    size_t const index = str_find_byte(str, delimiter);
+    if (index == str.length) {
+        return 0;
+    }
+
+    *before = str_create(str.data, index);
+    *after = str_create(str.data + index + 1, str.length - index - 1);
+    return 1;
+}
+
+// Iterates over the parts of a Str between delimiters.
+// Consecutive delimiters give empty parts, and an empty Str has one empty part.
+//
+// Usage:
+//     Str_Split split = str_split(line, ',');
+//     Str field;
+//     while (str_split_next(&split, &field)) {
+//         ...
+//     }
+typedef struct Str_Split Str_Split;
+struct Str_Split {
+    Str rest;
+    char delimiter;
+    char is_done;
+};
+
+__attribute__((warn_unused_result))
+Str_Split str_split(
+    Str const str,
+    char const delimiter
+) {
+    return (Str_Split) {
+        .rest = str,
+        .delimiter = delimiter,
+        .is_done = 0,
+    };
+}
+
+// Get the next part.
+// Return 1 if the part was set.
+// Return 0 if there are no more parts.
+__attribute__((warn_unused_result))
+int str_split_next(
+    Str_Split* const split,
+    Str* const part
+) {
+    assert(split != NULL);
+    assert(part != NULL);
+
+    if (split->is_done) {
+        return 0;
+    }
+
+    if (!str_split_once(split->rest, split->delimiter, part, &split->rest)) {
+        *part = split->rest;
+        split->is_done = 1;
+    }
+
+    return 1;
+}
+
+#endif
@@ -2,199 +2,1312 @@
 #define LIBCHIMP_STRING_BUILDER_H
 
 #include <assert.h>
+#include <math.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../mem/Arena.h"
+#include "../scan.h"
+#include "Str.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <errno.h>
+    #include <stdio.h>
+    #include <unistd.h>
+    #define LIBCHIMP_STRING_BUILDER_FD
+#endif
+
 typedef struct String_Builder String_Builder;
+
+typedef enum String_Builder_Error {
+    STRING_BUILDER_ERROR_NONE,
+    STRING_BUILDER_ERROR_SOME,
+} String_Builder_Error;
+
+// Called when a write of count bytes doesn't fit in the buffer.
+// The hook may replace the buffer and capacity, or flush and reset the length.
+// It should make room for count bytes and the NUL terminator, but a write of
+// bytes is also happy with any room it can fill before calling the hook again.
+typedef String_Builder_Error (*String_Builder_Grow)(String_Builder* builder, size_t count);
+
+// A builder over a fixed buffer fails when the buffer is full,
+// unless it has a grow hook to make more room.
 struct String_Builder {
-    char* const buffer;
-    size_t const capacity;
+    char* buffer;
+    size_t capacity;
     size_t length;
+    String_Builder_Grow grow;
+    void* context;
+};
+
+__attribute__((warn_unused_result))
+String_Builder string_builder_create(
+    char* const buffer,
+    size_t const capacity
+) {
+    assert(buffer != NULL);
+    assert(capacity > 0);
+    memset(buffer, 0, capacity);
+
+    return (String_Builder) {
+        .buffer = buffer,
+        .capacity = capacity,
+        .length = 0,
+        .grow = NULL,
+        .context = NULL,
+    };
+}
+
+// Make room for count more bytes and the NUL terminator, using the grow hook if needed.
+// Return 0 if all is good.
+// Return STRING_BUILDER_ERROR_SOME if there's no room.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_reserve(
+    String_Builder* const builder,
+    size_t const count
+) {
+    assert(builder != NULL);
+
+    if (count < builder->capacity - builder->length) {
+        return STRING_BUILDER_ERROR_NONE;
+    }
+
+    if (builder->grow == NULL || builder->grow(builder, count)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    return count < builder->capacity - builder->length ? STRING_BUILDER_ERROR_NONE : STRING_BUILDER_ERROR_SOME;
+}
+
+//
+//  ARENA GROWTH
+//
+
+// Grow the buffer inside the arena in the builder context.
+// The buffer is extended in place while it is the last allocation of the arena,
+// otherwise it moves to a new allocation of twice the capacity.
+// The new space is zeroed so that the buffer stays NUL-terminated.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_grow_arena(
+    String_Builder* const builder,
+    size_t const count
+) {
+    assert(builder != NULL);
+    assert(builder->context != NULL);
+
+    Arena* const arena = builder->context;
+    size_t const required = builder->length + count + 1;
+    size_t const doubled = builder->capacity * 2;
+
+    // Prefer doubling, but settle for the required size when the arena is nearly full.
+    size_t const capacities[] = { doubled > required ? doubled : required, required };
+
+    for (size_t i = 0; i < 2; i += 1) {
+        if (arena_realloc_last(arena, builder->buffer, builder->capacity, capacities[i]) != NULL) {
+            memset(builder->buffer + builder->capacity, 0, capacities[i] - builder->capacity);
+            builder->capacity = capacities[i];
+            return STRING_BUILDER_ERROR_NONE;
+        }
+    }
+
+    for (size_t i = 0; i < 2; i += 1) {
+        char* const buffer = arena_alloc(arena, capacities[i]);
+        if (buffer != NULL) {
+            memcpy(buffer, builder->buffer, builder->length);
+            builder->buffer = buffer;
+            builder->capacity = capacities[i];
+            return STRING_BUILDER_ERROR_NONE;
+        }
+    }
+
+    return STRING_BUILDER_ERROR_SOME;
+}
+
+// Create a builder that grows inside the arena instead of failing when it's full.
+// Return 0 if all is good.
+// Return STRING_BUILDER_ERROR_SOME if the arena has no room for the initial capacity.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_create_arena(
+    String_Builder* const builder,
+    Arena* const arena,
+    size_t const capacity
+) {
+    assert(builder != NULL);
+    assert(arena != NULL);
+    assert(capacity > 0);
+
+    char* const buffer = arena_alloc(arena, capacity);
+    if (buffer == NULL) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    *builder = (String_Builder) {
+        .buffer = buffer,
+        .capacity = capacity,
+        .length = 0,
+        .grow = string_builder_grow_arena,
+        .context = arena,
+    };
+
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+//
+//  STREAMING
+//
+
+#ifdef LIBCHIMP_STRING_BUILDER_FD
+
+// Write the buffered bytes to the file descriptor of a streaming builder and empty the buffer.
+// The buffer is not cleared, so it's not NUL-terminated after a flush.
+// Return 0 if all is good.
+// Return STRING_BUILDER_ERROR_SOME if the write fails, errno tells why.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_flush(String_Builder* const builder) {
+    assert(builder != NULL);
+    assert(builder->buffer != NULL);
+
+    int const fd = (int)(intptr_t)builder->context;
+    size_t written = 0;
+
+    while (written < builder->length) {
+        ssize_t const n = write(fd, builder->buffer + written, builder->length - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return STRING_BUILDER_ERROR_SOME;
+        }
+        written += (size_t)n;
+    }
+
+    builder->length = 0;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+// The grow hook of streaming builders: flush the full buffer.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_grow_fd(
+    String_Builder* const builder,
+    size_t const count
+) {
+    (void)count;
+    return string_builder_flush(builder);
+}
+
+// Create a builder that writes its buffer to the file descriptor whenever it fills up,
+// with one write call per buffer. Call string_builder_flush when done.
+// A single value, like a formatted number, must fit in the buffer.
+__attribute__((warn_unused_result))
+String_Builder string_builder_create_fd(
+    char* const buffer,
+    size_t const capacity,
+    int const fd
+) {
+    assert(buffer != NULL);
+    assert(capacity > 1);
+    assert(fd >= 0);
+
+    return (String_Builder) {
+        .buffer = buffer,
+        .capacity = capacity,
+        .length = 0,
+        .grow = string_builder_grow_fd,
+        .context = (void*)(intptr_t)fd,
+    };
+}
+
+// Create a streaming builder over the file descriptor of the file.
+// The file is flushed first so that earlier stdio output comes first. The builder
+// bypasses the stdio buffer, so flush the builder before using the file again.
+__attribute__((warn_unused_result))
+String_Builder string_builder_create_file(
+    char* const buffer,
+    size_t const capacity,
+    FILE* const file
+) {
+    assert(file != NULL);
+    fflush(file);
+    return string_builder_create_fd(buffer, capacity, fileno(file));
+}
+
+#endif
+
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_byte(
+    String_Builder* const builder,
+    char const byte
+) {
+    assert(builder != NULL);
+    assert(builder->buffer != NULL);
+    assert(builder->length < builder->capacity);
+    assert(byte > 0);
+
+    if (string_builder_reserve(builder, 1)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    builder->buffer[builder->length] = byte;
+    builder->length += 1;
+
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_bytes(
+    String_Builder* const builder,
+    char const* const bytes,
+    size_t const count
+) {
+    assert(builder != NULL);
+    assert(builder->buffer != NULL);
+    assert(builder->length < builder->capacity);
+    assert(bytes != NULL);
+
+    size_t written = 0;
+
+    if (count >= builder->capacity - builder->length) {
+        if (builder->grow == NULL) {
+            return STRING_BUILDER_ERROR_SOME;
+        }
+
+        // Fill the buffer before every grow, so that a flushing hook writes full buffers.
+        while (count - written >= builder->capacity - builder->length) {
+            size_t const room = builder->capacity - builder->length - 1;
+            memcpy(builder->buffer + builder->length, bytes + written, room);
+            builder->length += room;
+            written += room;
+
+            if (builder->grow(builder, count - written) || builder->capacity - builder->length <= 1) {
+                return STRING_BUILDER_ERROR_SOME;
+            }
+        }
+    }
+
+    memcpy(builder->buffer + builder->length, bytes + written, count - written);
+    builder->length += count - written;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_string(
+    String_Builder* const builder,
+    char const* const string
+) {
+    size_t const string_length = strlen(string);
+    return string_builder_write_bytes(builder, string, string_length);
+}
+
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_str(
+    String_Builder* const builder,
+    Str const str
+) {
+    return string_builder_write_bytes(builder, str.data, str.length);
+}
+
+// View the written bytes as a Str.
+// The view is invalidated when the builder grows or flushes.
+__attribute__((warn_unused_result))
+Str string_builder_to_str(String_Builder const* const builder) {
+    assert(builder != NULL);
+    return str_create(builder->buffer, builder->length);
+}
+
+// Count the decimal digits of the value.
+__attribute__((warn_unused_result))
+uint8_t string_builder_count_digits(uint64_t const value) {
+    static uint64_t const powers[] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+        100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+        10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+        100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+    };
+
+    // 1233 / 4096 approximates log10(2), which undershoots by at most one digit.
+    // The value is or'ed with 1 so that 0 counts as one digit.
+    uint32_t const bits = 64 - (uint32_t)__builtin_clzll(value | 1);
+    uint32_t const digits = (bits * 1233) >> 12;
+    return (uint8_t)(digits + ((value | 1) >= powers[digits]));
+}
+
+// Format the value backwards, two digits at a time, so that the last digit lands at end - 1.
+// The caller must have room for string_builder_count_digits(value) bytes before end.
+void string_builder_format_uint(
+    char* end,
+    uint64_t value
+) {
+    static char const pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    while (value >= 100) {
+        uint64_t const pair = (value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        memcpy(end, pairs + pair, 2);
+    }
+
+    if (value >= 10) {
+        end -= 2;
+        memcpy(end, pairs + value * 2, 2);
+    } else {
+        end -= 1;
+        *end = (char)('0' + value);
+    }
+}
+
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_int(
+    String_Builder* const builder,
+    int64_t const value
+) {
+    assert(builder != NULL);
+    assert(builder->buffer != NULL);
+    assert(builder->length < builder->capacity);
+
+    // Negate in unsigned arithmetic so that INT64_MIN doesn't overflow.
+    uint64_t const magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    size_t const sign = value < 0;
+    size_t const count = sign + string_builder_count_digits(magnitude);
+
+    if (string_builder_reserve(builder, count)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    char* const start = builder->buffer + builder->length;
+    *start = '-';
+    string_builder_format_uint(start + count, magnitude);
+
+    builder->length += count;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_uint(
+    String_Builder* const builder,
+    uint64_t const value
+) {
+    assert(builder != NULL);
+    assert(builder->buffer != NULL);
+    assert(builder->length < builder->capacity);
+
+    size_t const count = string_builder_count_digits(value);
+
+    if (string_builder_reserve(builder, count)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    string_builder_format_uint(builder->buffer + builder->length + count, value);
+
+    builder->length += count;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+//
+//  FLOATING POINT
+//
+
+// The default precision of %f, %e and %g.
+#define LIBCHIMP_STRING_BUILDER_PRECISION 6
+
+// Enough 10^9 limbs for the exact value of any double: 2^1024 has 309 digits and
+// the mantissa times 5^1074 of the smallest subnormals has 767.
+#define LIBCHIMP_STRING_BUILDER_DECIMAL_LIMBS 96
+
+// The exact decimal expansion of a finite double, without the sign.
+// The value is 0.digits * 10^point, without leading or trailing zeros.
+// Zero has no digits.
+typedef struct String_Builder_Decimal String_Builder_Decimal;
+struct String_Builder_Decimal {
+    char digits[LIBCHIMP_STRING_BUILDER_DECIMAL_LIMBS * 9];
+    int count;
+    int point;
 };
 
-typedef enum String_Builder_Error {
-    STRING_BUILDER_ERROR_NONE,
-    STRING_BUILDER_ERROR_SOME,
-} String_Builder_Error;
+// Write inf, -inf or nan like printf does.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_f64_special(
+    String_Builder* const builder,
+    double const value
+) {
+    if (isnan(value)) {
+        return string_builder_write_bytes(builder, "nan", 3);
+    }
+    if (signbit(value)) {
+        return string_builder_write_bytes(builder, "-inf", 4);
+    }
+    return string_builder_write_bytes(builder, "inf", 3);
+}
+
+// Split a double into a 53-bit significand and a binary exponent.
+void string_builder_f64_split(
+    double const value,
+    uint64_t* const significand,
+    int* const exponent
+) {
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint64_t const fraction = bits & ((1ull << 52) - 1);
+    int const biased_exponent = (int)((bits >> 52) & 0x7FF);
+
+    if (biased_exponent == 0) {
+        *significand = fraction;
+        *exponent = -1074;
+    } else {
+        *significand = fraction | (1ull << 52);
+        *exponent = biased_exponent - 1075;
+    }
+}
+
+// Split a float into a 24-bit significand and a binary exponent.
+void string_builder_f32_split(
+    float const value,
+    uint64_t* const significand,
+    int* const exponent
+) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t const fraction = bits & ((1u << 23) - 1);
+    int const biased_exponent = (int)((bits >> 23) & 0xFF);
+
+    if (biased_exponent == 0) {
+        *significand = fraction;
+        *exponent = -149;
+    } else {
+        *significand = fraction | (1u << 23);
+        *exponent = biased_exponent - 150;
+    }
+}
+
+// Compute the exact decimal expansion of significand * 2^exponent.
+// The significand is multiplied by 2^e, or by 5^-e which shifts the point by e digits,
+// in base 10^9 limbs.
+void string_builder_decimal_from_binary(
+    String_Builder_Decimal* const decimal,
+    uint64_t significand,
+    int const exponent
+) {
+    assert(decimal != NULL);
+
+    decimal->count = 0;
+    decimal->point = 1;
+
+    if (significand == 0) {
+        return;
+    }
+
+    uint32_t limbs[LIBCHIMP_STRING_BUILDER_DECIMAL_LIMBS];
+    size_t limb_count = 0;
+
+    while (significand > 0) {
+        limbs[limb_count] = (uint32_t)(significand % 1000000000);
+        significand /= 1000000000;
+        limb_count += 1;
+    }
+
+    // Multiply by 2^32 or 5^13 at a time, both fit a limb product in 64 bits.
+    int remaining = exponent < 0 ? -exponent : exponent;
+    while (remaining > 0) {
+        uint64_t multiplier = 0;
+        if (exponent > 0) {
+            int const shift = remaining < 32 ? remaining : 32;
+            multiplier = 1ull << shift;
+            remaining -= shift;
+        } else {
+            int const power = remaining < 13 ? remaining : 13;
+            multiplier = 1;
+            for (int i = 0; i < power; i += 1) {
+                multiplier *= 5;
+            }
+            remaining -= power;
+        }
+
+        uint64_t carry = 0;
+        for (size_t i = 0; i < limb_count; i += 1) {
+            uint64_t const product = (uint64_t)limbs[i] * multiplier + carry;
+            limbs[i] = (uint32_t)(product % 1000000000);
+            carry = product / 1000000000;
+        }
+        while (carry > 0) {
+            assert(limb_count < LIBCHIMP_STRING_BUILDER_DECIMAL_LIMBS);
+            limbs[limb_count] = (uint32_t)(carry % 1000000000);
+            carry /= 1000000000;
+            limb_count += 1;
+        }
+    }
+
+    // The most significant limb has no leading zeros, the others are padded to 9 digits.
+    uint32_t const top = limbs[limb_count - 1];
+    int const top_digits = string_builder_count_digits(top);
+    string_builder_format_uint(decimal->digits + top_digits, top);
+    int count = top_digits;
+
+    for (size_t i = limb_count - 1; i > 0; i -= 1) {
+        memset(decimal->digits + count, '0', 9);
+        string_builder_format_uint(decimal->digits + count + 9, limbs[i - 1]);
+        count += 9;
+    }
+
+    decimal->point = count - (exponent < 0 ? -exponent : 0);
+
+    while (count > 0 && decimal->digits[count - 1] == '0') {
+        count -= 1;
+    }
+    decimal->count = count;
+}
+
+// Compute the exact decimal expansion of the absolute value of a finite double.
+void string_builder_decimal_from_f64(
+    String_Builder_Decimal* const decimal,
+    double const value
+) {
+    assert(decimal != NULL);
+    assert(isfinite(value));
+
+    uint64_t significand = 0;
+    int exponent = 0;
+    string_builder_f64_split(value, &significand, &exponent);
+    string_builder_decimal_from_binary(decimal, significand, exponent);
+}
+
+// Cut to the given number of significant digits, adding one to the last kept digit
+// if round_up is set.
+void string_builder_decimal_cut(
+    String_Builder_Decimal* const decimal,
+    int const digits,
+    int const round_up
+) {
+    assert(decimal != NULL);
+    assert(digits >= 0);
+
+    if (digits >= decimal->count) {
+        return;
+    }
+
+    int count = digits;
+
+    if (round_up) {
+        while (count > 0 && decimal->digits[count - 1] == '9') {
+            count -= 1;
+        }
+        if (count == 0) {
+            decimal->digits[0] = '1';
+            decimal->point += 1;
+            count = 1;
+        } else {
+            decimal->digits[count - 1] += 1;
+        }
+    }
+
+    while (count > 0 && decimal->digits[count - 1] == '0') {
+        count -= 1;
+    }
+    decimal->count = count;
+}
+
+// Round to the given number of significant digits, with ties going to even.
+// The digits are exact, so a tie is a 5 followed by nothing at all.
+void string_builder_decimal_round(
+    String_Builder_Decimal* const decimal,
+    int const digits
+) {
+    assert(decimal != NULL);
+
+    if (digits >= decimal->count) {
+        return;
+    }
+
+    if (digits < 0) {
+        decimal->count = 0;
+        return;
+    }
+
+    char const next = decimal->digits[digits];
+    int round_up = next > '5';
+
+    if (next == '5') {
+        if (digits + 1 < decimal->count) {
+            round_up = 1;
+        } else {
+            round_up = digits > 0 && (decimal->digits[digits - 1] - '0') % 2 == 1;
+        }
+    }
+
+    string_builder_decimal_cut(decimal, digits, round_up);
+}
+
+// Compare two decimals.
+// Return a negative number, zero or a positive number like strcmp.
+__attribute__((warn_unused_result))
+int string_builder_decimal_compare(
+    String_Builder_Decimal const* const x,
+    String_Builder_Decimal const* const y
+) {
+    assert(x != NULL);
+    assert(y != NULL);
+
+    if (x->count == 0 || y->count == 0) {
+        return (x->count > 0) - (y->count > 0);
+    }
+    if (x->point != y->point) {
+        return x->point < y->point ? -1 : 1;
+    }
+
+    // Neither has trailing zeros, so the one that goes on is the larger one.
+    int const count = x->count < y->count ? x->count : y->count;
+    int const order = memcmp(x->digits, y->digits, (size_t)count);
+    if (order != 0) {
+        return order;
+    }
+    return (x->count > count) - (y->count > count);
+}
+
+// Write a rounded decimal with a fixed number of digits after the point, like %f.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_decimal_fixed(
+    String_Builder* const builder,
+    int const is_negative,
+    String_Builder_Decimal const* const decimal,
+    int const precision
+) {
+    assert(builder != NULL);
+    assert(decimal != NULL);
+    assert(precision >= 0);
+
+    size_t const integer_digits = decimal->point > 0 ? (size_t)decimal->point : 1;
+    size_t const count = (size_t)is_negative + integer_digits + (precision > 0 ? 1 + (size_t)precision : 0);
+
+    if (string_builder_reserve(builder, count)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    char* out = builder->buffer + builder->length;
+
+    if (is_negative) {
+        *out++ = '-';
+    }
+
+    // Digit i is the one with weight 10^(point - 1 - i), zero outside of the digits.
+    int index = decimal->point > 0 ? 0 : decimal->point - 1;
+    int const end = decimal->point + precision;
+
+    for (size_t i = 0; i < integer_digits; i += 1, index += 1) {
+        *out++ = index >= 0 && index < decimal->count ? decimal->digits[index] : '0';
+    }
+
+    if (precision > 0) {
+        *out++ = '.';
+        for (; index < end; index += 1) {
+            *out++ = index >= 0 && index < decimal->count ? decimal->digits[index] : '0';
+        }
+    }
+
+    builder->length += count;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+// Write a rounded decimal in scientific notation, like %e.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_decimal_exponent(
+    String_Builder* const builder,
+    int const is_negative,
+    String_Builder_Decimal const* const decimal,
+    int const precision
+) {
+    assert(builder != NULL);
+    assert(decimal != NULL);
+    assert(precision >= 0);
+
+    int const exponent = decimal->count > 0 ? decimal->point - 1 : 0;
+    uint64_t const magnitude = (uint64_t)(exponent < 0 ? -exponent : exponent);
+    size_t const exponent_digits = magnitude < 10 ? 2 : string_builder_count_digits(magnitude);
+    size_t const count = (size_t)is_negative + 1 + (precision > 0 ? 1 + (size_t)precision : 0) + 2 + exponent_digits;
+
+    if (string_builder_reserve(builder, count)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    char* out = builder->buffer + builder->length;
+
+    if (is_negative) {
+        *out++ = '-';
+    }
+
+    *out++ = decimal->count > 0 ? decimal->digits[0] : '0';
+
+    if (precision > 0) {
+        *out++ = '.';
+        for (int i = 1; i <= precision; i += 1) {
+            *out++ = i < decimal->count ? decimal->digits[i] : '0';
+        }
+    }
+
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    *out = '0';
+    string_builder_format_uint(out + exponent_digits, magnitude);
+
+    builder->length += count;
+    return STRING_BUILDER_ERROR_NONE;
+}
 
+// Write a double with a fixed number of digits after the point, like %.*f.
+// The result is exact and correctly rounded, and doesn't depend on the locale.
 __attribute__((warn_unused_result))
-String_Builder string_builder_create(
-    char* const buffer,
-    size_t const capacity
+String_Builder_Error string_builder_write_f64_fixed(
+    String_Builder* const builder,
+    double const value,
+    int const precision
 ) {
-    assert(buffer != NULL);
-    assert(capacity > 0);
-    memset(buffer, 0, capacity);
+    assert(builder != NULL);
+    assert(builder->buffer != NULL);
+    assert(builder->length < builder->capacity);
+    assert(precision >= 0);
 
-    return (String_Builder) {
-        .buffer = buffer,
-        .capacity = capacity,
-        .length = 0,
-    };
+    if (!isfinite(value)) {
+        return string_builder_write_f64_special(builder, value);
+    }
+
+    String_Builder_Decimal decimal;
+    string_builder_decimal_from_f64(&decimal, value);
+    string_builder_decimal_round(&decimal, decimal.point + precision);
+    return string_builder_write_decimal_fixed(builder, signbit(value) != 0, &decimal, precision);
 }
 
+// Write a double in scientific notation, like %.*e.
+// The result is exact and correctly rounded, and doesn't depend on the locale.
 __attribute__((warn_unused_result))
-String_Builder_Error string_builder_write_byte(
+String_Builder_Error string_builder_write_f64_exponent(
     String_Builder* const builder,
-    char const byte
+    double const value,
+    int const precision
 ) {
     assert(builder != NULL);
     assert(builder->buffer != NULL);
     assert(builder->length < builder->capacity);
-    assert(byte > 0);
+    assert(precision >= 0);
 
-    if (builder->length + 1 >= builder->capacity) {
-        return STRING_BUILDER_ERROR_SOME;
+    if (!isfinite(value)) {
+        return string_builder_write_f64_special(builder, value);
     }
 
-    builder->buffer[builder->length] = byte;
-    builder->length += 1;
-
-    return STRING_BUILDER_ERROR_NONE;
+    String_Builder_Decimal decimal;
+    string_builder_decimal_from_f64(&decimal, value);
+    string_builder_decimal_round(&decimal, precision + 1);
+    return string_builder_write_decimal_exponent(builder, signbit(value) != 0, &decimal, precision);
 }
 
+// Write a double with the given number of significant digits, like %.*g.
+// Trailing zeros are removed, as printf does without the # flag.
 __attribute__((warn_unused_result))
-String_Builder_Error string_builder_write_bytes(
+String_Builder_Error string_builder_write_f64_general(
     String_Builder* const builder,
-    char* const bytes,
-    size_t const count
+    double const value,
+    int const precision
 ) {
     assert(builder != NULL);
     assert(builder->buffer != NULL);
     assert(builder->length < builder->capacity);
-    assert(bytes != NULL);
+    assert(precision >= 0);
 
-    size_t const buffer_length = builder->length;
-    size_t const required_capacity = buffer_length + count;
-
-    if (required_capacity >= builder->capacity) {
-        return STRING_BUILDER_ERROR_SOME;
+    if (!isfinite(value)) {
+        return string_builder_write_f64_special(builder, value);
     }
 
-    for (size_t i = 0; i < count; i += 1) {
-        int const buffer_index = buffer_length + i;
-        builder->buffer[buffer_index] = bytes[i];
+    int const significant = precision > 0 ? precision : 1;
+    int const is_negative = signbit(value) != 0;
+
+    String_Builder_Decimal decimal;
+    string_builder_decimal_from_f64(&decimal, value);
+    string_builder_decimal_round(&decimal, significant);
+
+    int const exponent = decimal.count > 0 ? decimal.point - 1 : 0;
+
+    if (-4 <= exponent && exponent < significant) {
+        int const fraction = decimal.count - decimal.point;
+        return string_builder_write_decimal_fixed(builder, is_negative, &decimal, fraction > 0 ? fraction : 0);
     }
 
-    builder->length += count;
-    return STRING_BUILDER_ERROR_NONE;
+    int const fraction = decimal.count - 1;
+    return string_builder_write_decimal_exponent(builder, is_negative, &decimal, fraction > 0 ? fraction : 0);
 }
 
+//
+//  SHORTEST ROUND TRIP (GRISU)
+//
+
+// A floating point number with a 64-bit significand: f * 2^e.
+typedef struct String_Builder_Diy_Fp String_Builder_Diy_Fp;
+struct String_Builder_Diy_Fp {
+    uint64_t f;
+    int e;
+};
+
+// Multiply the significands, keeping the rounded upper 64 bits.
 __attribute__((warn_unused_result))
-String_Builder_Error string_builder_write_string(
-    String_Builder* const builder,
-    char* const string
+String_Builder_Diy_Fp string_builder_diy_fp_multiply(
+    String_Builder_Diy_Fp const x,
+    String_Builder_Diy_Fp const y
 ) {
-    size_t const string_length = strlen(string);
-    return string_builder_write_bytes(builder, string, string_length);
+    uint64_t const mask = 0xFFFFFFFFull;
+    uint64_t const a = x.f >> 32;
+    uint64_t const b = x.f & mask;
+    uint64_t const c = y.f >> 32;
+    uint64_t const d = y.f & mask;
+    uint64_t const ac = a * c;
+    uint64_t const bc = b * c;
+    uint64_t const ad = a * d;
+    uint64_t const bd = b * d;
+    uint64_t const middle = (bd >> 32) + (ad & mask) + (bc & mask) + (1ull << 31);
+
+    return (String_Builder_Diy_Fp) {
+        .f = ac + (ad >> 32) + (bc >> 32) + (middle >> 32),
+        .e = x.e + y.e + 64,
+    };
 }
 
 __attribute__((warn_unused_result))
-String_Builder_Error string_builder_write_int(
-    String_Builder* const builder,
-    int64_t const value
+String_Builder_Diy_Fp string_builder_diy_fp_normalize(String_Builder_Diy_Fp const x) {
+    int const shift = __builtin_clzll(x.f);
+    return (String_Builder_Diy_Fp) { .f = x.f << shift, .e = x.e - shift };
+}
+
+// Get a cached power of ten c = 10^-k such that e + c.e lands in [-60, -32].
+__attribute__((warn_unused_result))
+String_Builder_Diy_Fp string_builder_cached_power(
+    int const e,
+    int* const k
 ) {
-    assert(builder != NULL);
-    assert(builder->buffer != NULL);
-    assert(builder->length < builder->capacity);
+    // The powers 10^-348, 10^-340, ..., 10^340 rounded to 64 bits.
+    static uint64_t const significands[] = {
+        0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull,
+        0xcf42894a5dce35eaull, 0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull,
+        0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full, 0xbe5691ef416bd60cull,
+        0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+        0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull,
+        0xc21094364dfb5637ull, 0x9096ea6f3848984full, 0xd77485cb25823ac7ull,
+        0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull, 0xb23867fb2a35b28eull,
+        0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+        0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull,
+        0xb5b5ada8aaff80b8ull, 0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull,
+        0x964e858c91ba2655ull, 0xdff9772470297ebdull, 0xa6dfbd9fb8e5b88full,
+        0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+        0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull,
+        0xaa242499697392d3ull, 0xfd87b5f28300ca0eull, 0xbce5086492111aebull,
+        0x8cbccc096f5088ccull, 0xd1b71758e219652cull, 0x9c40000000000000ull,
+        0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+        0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull,
+        0x9f4f2726179a2245ull, 0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull,
+        0x83c7088e1aab65dbull, 0xc45d1df942711d9aull, 0x924d692ca61be758ull,
+        0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+        0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull,
+        0x952ab45cfa97a0b3ull, 0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull,
+        0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull, 0x88fcf317f22241e2ull,
+        0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+        0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull,
+        0x8bab8eefb6409c1aull, 0xd01fef10a657842cull, 0x9b10a4e5e9913129ull,
+        0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull, 0x80444b5e7aa7cf85ull,
+        0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+        0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull,
+    };
+    static int16_t const exponents[] = {
+        -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+        -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+        -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+        -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+        56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+        375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+        694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+        1013, 1039, 1066,
+    };
 
-    if (-1 < value && value < 10) {
-        return string_builder_write_byte(builder, '0' + value);
+    double const estimate = (-61 - e) * 0.30102999566398114 + 347;
+    int power = (int)estimate;
+    if (estimate - power > 0.0) {
+        power += 1;
     }
 
-    if (-10 < value && value < 0) {
-        if (string_builder_write_byte(builder, '-')) {
-            return STRING_BUILDER_ERROR_SOME;
+    size_t const index = (size_t)((power >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+
+    return (String_Builder_Diy_Fp) { .f = significands[index], .e = exponents[index] };
+}
+
+// Nudge the last digit towards the exact value while it stays inside the rounding interval.
+void string_builder_grisu_round(
+    char* const buffer,
+    int const length,
+    uint64_t const delta,
+    uint64_t rest,
+    uint64_t const ten_kappa,
+    uint64_t const distance
+) {
+    while (
+        rest < distance
+        && delta - rest >= ten_kappa
+        && (rest + ten_kappa < distance || distance - rest > rest + ten_kappa - distance)
+    ) {
+        buffer[length - 1] -= 1;
+        rest += ten_kappa;
+    }
+}
+
+// Check whether a shorter result might fit once the interval [high - delta, high] is widened
+// by two units on both sides, that is whether the widened interval holds a multiple of ten
+// times the weight of the last digit. The rest is high modulo ten times that weight.
+__attribute__((warn_unused_result))
+int string_builder_grisu_is_unsure(
+    uint64_t const rest,
+    uint64_t const ten_kappa,
+    uint64_t const delta,
+    uint64_t const unit,
+    int const length
+) {
+    if (length <= 1) {
+        return 0;
+    }
+    if (rest <= delta + 2 * unit) {
+        return 1;
+    }
+    return ten_kappa <= UINT64_MAX / 10 && ten_kappa * 10 - rest <= 2 * unit;
+}
+
+// Generate the shortest digits of w that stay inside the interval [high - delta, high].
+// Return 1 if a shorter result might fit the interval widened by the error of the products.
+__attribute__((warn_unused_result))
+int string_builder_grisu_digits(
+    String_Builder_Diy_Fp const w,
+    String_Builder_Diy_Fp const high,
+    uint64_t delta,
+    char* const buffer,
+    int* const length,
+    int* const k
+) {
+    static uint32_t const powers[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+    };
+
+    int const shift = -high.e;
+    uint64_t const one = 1ull << shift;
+    uint64_t const distance = high.f - w.f;
+    uint32_t integral = (uint32_t)(high.f >> shift);
+    uint64_t fractional = high.f & (one - 1);
+    uint64_t unit = 1;
+    int kappa = string_builder_count_digits(integral);
+
+    *length = 0;
+
+    while (kappa > 0) {
+        uint32_t const digit = integral / powers[kappa - 1];
+        integral %= powers[kappa - 1];
+        if (digit != 0 || *length != 0) {
+            buffer[*length] = (char)('0' + digit);
+            *length += 1;
+        }
+        kappa -= 1;
+
+        uint64_t const rest = ((uint64_t)integral << shift) + fractional;
+        if (rest <= delta) {
+            uint64_t const ten_kappa = (uint64_t)powers[kappa] << shift;
+            *k += kappa;
+            string_builder_grisu_round(buffer, *length, delta, rest, ten_kappa, distance);
+            return string_builder_grisu_is_unsure(rest + digit * ten_kappa, ten_kappa, delta, unit, *length);
         }
-        return string_builder_write_byte(builder, '0' + value);
     }
 
-    int64_t const sign = value < 0 ? -1 : 1;
-    uint64_t tmp = sign == -1 ? -value : value;
+    for (;;) {
+        fractional *= 10;
+        delta *= 10;
+        unit *= 10;
+        uint64_t const rest = fractional;
+        char const digit = (char)(fractional >> shift);
+        if (digit != 0 || *length != 0) {
+            buffer[*length] = (char)('0' + digit);
+            *length += 1;
+        }
+        fractional &= one - 1;
+        kappa -= 1;
 
-    char buffer [20] = {0};
-    uint8_t length = 0;
+        if (fractional < delta) {
+            *k += kappa;
+            int const index = -kappa;
+            string_builder_grisu_round(buffer, *length, delta, fractional, one, index < 10 ? distance * powers[index] : 0);
+            return string_builder_grisu_is_unsure(rest, one, delta, unit, *length);
+        }
+    }
+}
 
-    while (tmp > 0) {
-        uint8_t modulo = tmp % 10;
-        tmp /= 10;
-        buffer[length] = '0' + modulo;
-        length += 1;
+// Find the shortest digits that round trip to significand * 2^exponent, trying the lengths
+// below the current one. Each candidate is rounded from the exact decimal expansion and
+// compared exactly to the halfway points to the neighbouring values.
+// The buffer is left as it was if none of the lengths round trip.
+void string_builder_shortest_exact(
+    uint64_t const significand,
+    int const exponent,
+    int const is_lower_closer,
+    char* const buffer,
+    int* const length,
+    int* const k
+) {
+    String_Builder_Decimal exact;
+    String_Builder_Decimal low;
+    String_Builder_Decimal high;
+    string_builder_decimal_from_binary(&exact, significand, exponent);
+    string_builder_decimal_from_binary(&high, (significand << 1) + 1, exponent - 1);
+    if (is_lower_closer) {
+        string_builder_decimal_from_binary(&low, (significand << 2) - 1, exponent - 2);
+    } else {
+        string_builder_decimal_from_binary(&low, (significand << 1) - 1, exponent - 1);
     }
 
-    if (sign == -1) {
-        if (string_builder_write_byte(builder, '-')) {
-            return STRING_BUILDER_ERROR_SOME;
+    // Reading rounds ties to even, so the halfway points belong to an even significand.
+    int const is_even = significand % 2 == 0;
+
+    for (int digits = 1; digits < *length; digits += 1) {
+        // The nearest candidate goes first, then the one on the other side of the value.
+        String_Builder_Decimal candidates[2] = { exact, exact };
+        string_builder_decimal_round(&candidates[0], digits);
+        string_builder_decimal_cut(&candidates[1], digits, string_builder_decimal_compare(&candidates[0], &exact) <= 0);
+
+        for (size_t i = 0; i < 2; i += 1) {
+            String_Builder_Decimal const* const candidate = &candidates[i];
+            int const above_low = string_builder_decimal_compare(candidate, &low);
+            int const below_high = string_builder_decimal_compare(&high, candidate);
+
+            if ((above_low > 0 || (is_even && above_low == 0)) && (below_high > 0 || (is_even && below_high == 0))) {
+                memcpy(buffer, candidate->digits, (size_t)candidate->count);
+                *length = candidate->count;
+                *k = candidate->point - candidate->count;
+                return;
+            }
         }
     }
+}
 
-    for (uint8_t i = 0; i < length; i += 1) {
-        if (string_builder_write_byte(builder, buffer[length - i - 1])) {
-            return STRING_BUILDER_ERROR_SOME;
+// Generate the shortest digits that round trip to the positive value significand * 2^exponent.
+// The lower boundary is half as far when the significand is a power of two, except for the
+// smallest normal, which is_lower_closer tells.
+// The value is buffer * 10^k, and the buffer holds at most 17 digits.
+// Grisu2 stays inside an interval narrowed by the error of the products, so it can miss
+// a shorter result near the edges. Only when the widened interval could hold one are the
+// digits searched for exactly, like Grisu3 does.
+void string_builder_grisu(
+    uint64_t const significand,
+    int const exponent,
+    int const is_lower_closer,
+    char* const buffer,
+    int* const length,
+    int* const k
+) {
+    String_Builder_Diy_Fp const v = { .f = significand, .e = exponent };
+
+    // The boundaries are halfway to the neighbouring values.
+    String_Builder_Diy_Fp high = string_builder_diy_fp_normalize((String_Builder_Diy_Fp) {
+        .f = (v.f << 1) + 1,
+        .e = v.e - 1,
+    });
+    String_Builder_Diy_Fp low = is_lower_closer
+        ? (String_Builder_Diy_Fp) { .f = (v.f << 2) - 1, .e = v.e - 2 }
+        : (String_Builder_Diy_Fp) { .f = (v.f << 1) - 1, .e = v.e - 1 };
+    low.f <<= low.e - high.e;
+    low.e = high.e;
+
+    String_Builder_Diy_Fp const power = string_builder_cached_power(high.e, k);
+    String_Builder_Diy_Fp const w = string_builder_diy_fp_multiply(string_builder_diy_fp_normalize(v), power);
+    high = string_builder_diy_fp_multiply(high, power);
+    low = string_builder_diy_fp_multiply(low, power);
+
+    // Stay strictly inside the interval, the products may be off by one ulp.
+    high.f -= 1;
+    low.f += 1;
+
+    if (string_builder_grisu_digits(w, high, high.f - low.f, buffer, length, k)) {
+        string_builder_shortest_exact(significand, exponent, is_lower_closer, buffer, length, k);
+    }
+}
+
+// Write the shortest digits that read back as significand * 2^exponent, in the format
+// used by JavaScript and JSON. See string_builder_grisu for is_lower_closer.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_shortest(
+    String_Builder* const builder,
+    int const is_negative,
+    uint64_t const significand,
+    int const exponent,
+    int const is_lower_closer
+) {
+    char output[32];
+    size_t n = 0;
+
+    if (is_negative) {
+        output[n++] = '-';
+    }
+
+    if (significand == 0) {
+        output[n++] = '0';
+        return string_builder_write_bytes(builder, output, n);
+    }
+
+    char digits[20];
+    int length = 0;
+    int k = 0;
+    string_builder_grisu(significand, exponent, is_lower_closer, digits, &length, &k);
+
+    // The value is 0.digits * 10^point.
+    int const point = length + k;
+
+    if (length <= point && point <= 21) {
+        memcpy(output + n, digits, (size_t)length);
+        n += (size_t)length;
+        memset(output + n, '0', (size_t)(point - length));
+        n += (size_t)(point - length);
+    } else if (0 < point && point <= 21) {
+        memcpy(output + n, digits, (size_t)point);
+        n += (size_t)point;
+        output[n++] = '.';
+        memcpy(output + n, digits + point, (size_t)(length - point));
+        n += (size_t)(length - point);
+    } else if (-6 < point && point <= 0) {
+        output[n++] = '0';
+        output[n++] = '.';
+        memset(output + n, '0', (size_t)-point);
+        n += (size_t)-point;
+        memcpy(output + n, digits, (size_t)length);
+        n += (size_t)length;
+    } else {
+        int const power = point - 1;
+        uint64_t const magnitude = (uint64_t)(power < 0 ? -power : power);
+        output[n++] = digits[0];
+        if (length > 1) {
+            output[n++] = '.';
+            memcpy(output + n, digits + 1, (size_t)(length - 1));
+            n += (size_t)(length - 1);
         }
+        output[n++] = 'e';
+        output[n++] = power < 0 ? '-' : '+';
+        n += string_builder_count_digits(magnitude);
+        string_builder_format_uint(output + n, magnitude);
     }
 
-    return STRING_BUILDER_ERROR_NONE;
+    return string_builder_write_bytes(builder, output, n);
 }
 
+// Write the shortest decimal representation that reads back as the same double.
+// The format is the one used by JavaScript and JSON: 1.5, 0.001, 1e+21, 1.5e-7.
+// Doesn't allocate or depend on the locale.
 __attribute__((warn_unused_result))
-String_Builder_Error string_builder_write_uint(
+String_Builder_Error string_builder_write_f64(
     String_Builder* const builder,
-    uint64_t const value
+    double const value
 ) {
     assert(builder != NULL);
     assert(builder->buffer != NULL);
     assert(builder->length < builder->capacity);
 
-    if (value < 10) {
-        return string_builder_write_byte(builder, '0' + value);
+    if (!isfinite(value)) {
+        return string_builder_write_f64_special(builder, value);
     }
 
-    uint64_t tmp = value;
-    char buffer [21] = {0};
-    uint8_t length = 0;
+    uint64_t significand = 0;
+    int exponent = 0;
+    string_builder_f64_split(value, &significand, &exponent);
+    return string_builder_write_shortest(
+        builder, signbit(value) != 0, significand, exponent, significand == (1ull << 52) && exponent > -1074
+    );
+}
 
-    while (tmp > 0) {
-        uint8_t modulo = tmp % 10;
-        tmp /= 10;
-        buffer[length] = '0' + modulo;
-        length += 1;
-    }
+// Write the shortest decimal representation that reads back as the same float,
+// like string_builder_write_f64 does for doubles. 0.1f is written as 0.1.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_f32(
+    String_Builder* const builder,
+    float const value
+) {
+    assert(builder != NULL);
+    assert(builder->buffer != NULL);
+    assert(builder->length < builder->capacity);
 
-    for (uint8_t i = 0; i < length; i += 1) {
-        if (string_builder_write_byte(builder, buffer[length - i - 1])) {
-            return STRING_BUILDER_ERROR_SOME;
-        }
+    if (!isfinite(value)) {
+        return string_builder_write_f64_special(builder, value);
     }
 
-    return STRING_BUILDER_ERROR_NONE;
+    uint64_t significand = 0;
+    int exponent = 0;
+    string_builder_f32_split(value, &significand, &exponent);
+    return string_builder_write_shortest(
+        builder, signbit(value) != 0, significand, exponent, significand == (1u << 23) && exponent > -149
+    );
 }
 
-__attribute__((warn_unused_result))
-String_Builder_Error string_builder_printf(
+// Format like vprintf: %d %i %u %c %s %f %e %g and %%.
+// Integers take the l, ll and z length modifiers, floats take a .precision.
+// An unknown conversion is written as is.
+__attribute__((warn_unused_result, format(printf, 2, 0)))
+String_Builder_Error string_builder_vprintf(
     String_Builder* const builder,
-    char* const format_string,
-    ...
+    char const* const format_string,
+    va_list var_args
 ) {
     assert(builder != NULL);
     assert(builder->buffer != NULL);
     assert(builder->length < builder->capacity);
+    assert(format_string != NULL);
 
-    va_list var_args;
-    va_start(var_args, format_string);
-
-    for (int i = 0; format_string[i] != 0; i += 1) {
+    for (size_t i = 0; format_string[i] != 0; i += 1) {
 
         if (format_string[i] != '%') {
-            if (string_builder_write_byte(builder, format_string[i])) {
+            // Copy the literal run up to the next conversion at once.
+            size_t n = 1;
+            while (format_string[i + n] != 0 && format_string[i + n] != '%') {
+                n += 1;
+            }
+            if (string_builder_write_bytes(builder, format_string + i, n)) {
                 return STRING_BUILDER_ERROR_SOME;
             }
+            i += n - 1;
             continue;
         }
 
         i += 1;
+
+        int precision = -1;
+        if (format_string[i] == '.') {
+            precision = 0;
+            i += 1;
+            while ('0' <= format_string[i] && format_string[i] <= '9') {
+                precision = precision * 10 + (format_string[i] - '0');
+                i += 1;
+            }
+        }
+
+        // 0 for int, 1 for long, 2 for long long and 3 for size_t.
+        int size = 0;
+        if (format_string[i] == 'l') {
+            size = 1;
+            i += 1;
+            if (format_string[i] == 'l') {
+                size = 2;
+                i += 1;
+            }
+        } else if (format_string[i] == 'z') {
+            size = 3;
+            i += 1;
+        }
+
         if (format_string[i] == 0) {
             if (string_builder_write_byte(builder, '%')) {
                 return STRING_BUILDER_ERROR_SOME;
@@ -202,52 +1315,317 @@ String_Builder_Error string_builder_printf(
             break;
         }
 
+        int const digits = precision < 0 ? LIBCHIMP_STRING_BUILDER_PRECISION : precision;
+        String_Builder_Error error = STRING_BUILDER_ERROR_NONE;
+
         switch (format_string[i]) {
 
             case 'd':
             case 'i': {
-                int64_t const value = va_arg(var_args, int64_t);
-                if (string_builder_write_int(builder, value)) {
-                    return STRING_BUILDER_ERROR_SOME;
+                int64_t value = 0;
+                switch (size) {
+                    case 0: value = va_arg(var_args, int); break;
+                    case 1: value = va_arg(var_args, long); break;
+                    case 2: value = va_arg(var_args, long long); break;
+                    default: value = va_arg(var_args, ptrdiff_t); break;
                 }
+                error = string_builder_write_int(builder, value);
                 break;
             }
 
             case 'u': {
-                uint64_t const value = va_arg(var_args, uint64_t);
-                if (string_builder_write_uint(builder, value)) {
-                    return STRING_BUILDER_ERROR_SOME;
+                uint64_t value = 0;
+                switch (size) {
+                    case 0: value = va_arg(var_args, unsigned int); break;
+                    case 1: value = va_arg(var_args, unsigned long); break;
+                    case 2: value = va_arg(var_args, unsigned long long); break;
+                    default: value = va_arg(var_args, size_t); break;
                 }
+                error = string_builder_write_uint(builder, value);
                 break;
             }
 
             case 'c': {
-                char const value = va_arg(var_args, int);
-                if (string_builder_write_byte(builder, value)) {
-                    return STRING_BUILDER_ERROR_SOME;
-                }
+                char const value = (char)va_arg(var_args, int);
+                error = string_builder_write_byte(builder, value);
                 break;
             }
 
             case 's': {
-                char* const value = va_arg(var_args, char*);
-                if (string_builder_write_string(builder, value)) {
-                    return STRING_BUILDER_ERROR_SOME;
-                }
+                char const* const value = va_arg(var_args, char const*);
+                error = string_builder_write_string(builder, value);
+                break;
+            }
+
+            case 'f': {
+                error = string_builder_write_f64_fixed(builder, va_arg(var_args, double), digits);
+                break;
+            }
+
+            case 'e': {
+                error = string_builder_write_f64_exponent(builder, va_arg(var_args, double), digits);
+                break;
+            }
+
+            case 'g': {
+                error = string_builder_write_f64_general(builder, va_arg(var_args, double), digits);
+                break;
+            }
+
+            case '%': {
+                error = string_builder_write_byte(builder, '%');
                 break;
             }
 
             default: {
-                char buffer[] = { '%', format_string[i] };
-                if (string_builder_write_bytes(builder, buffer, sizeof(buffer))) {
-                    return STRING_BUILDER_ERROR_SOME;
-                }
+                char const buffer[] = { '%', format_string[i] };
+                error = string_builder_write_bytes(builder, buffer, sizeof(buffer));
             }
         } // switch
+
+        if (error) {
+            return error;
+        }
     } // for
 
     return STRING_BUILDER_ERROR_NONE;
 }
 
+// Format like printf, see string_builder_vprintf.
+__attribute__((warn_unused_result, format(printf, 2, 3)))
+String_Builder_Error string_builder_printf(
+    String_Builder* const builder,
+    char const* const format_string,
+    ...
+) {
+    va_list var_args;
+    va_start(var_args, format_string);
+    String_Builder_Error const error = string_builder_vprintf(builder, format_string, var_args);
+    va_end(var_args);
+    return error;
+}
+
+//
+//  ESCAPING
+//
+
+// Write the bytes as a quoted JSON string.
+// Quotes, backslashes and control characters are escaped, everything else
+// (including UTF-8) is copied in runs between the bytes that need escaping.
+// Return 0 if all is good.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_json_string(
+    String_Builder* const builder,
+    char const* const string,
+    size_t const length
+) {
+    assert(builder != NULL);
+    assert(string != NULL || length == 0);
+
+    if (string_builder_write_byte(builder, '"')) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    size_t i = 0;
+
+    while (i < length) {
+        size_t const clean = scan_find_json_escape(string + i, length - i);
+        if (string_builder_write_bytes(builder, string + i, clean)) {
+            return STRING_BUILDER_ERROR_SOME;
+        }
+        i += clean;
+
+        if (i == length) {
+            break;
+        }
+
+        char escape[6] = { '\\', 0 };
+        size_t escape_length = 2;
+
+        switch (string[i]) {
+            case '"': escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            default: {
+                char const* const hex = "0123456789abcdef";
+                uint8_t const byte = (uint8_t)string[i];
+                memcpy(escape + 1, "u00", 3);
+                escape[4] = hex[byte >> 4];
+                escape[5] = hex[byte & 0xF];
+                escape_length = 6;
+            }
+        }
+
+        if (string_builder_write_bytes(builder, escape, escape_length)) {
+            return STRING_BUILDER_ERROR_SOME;
+        }
+        i += 1;
+    }
+
+    return string_builder_write_byte(builder, '"');
+}
+
+// Write the bytes as a CSV field (RFC 4180).
+// A field containing the delimiter, a quote or a line break is quoted with its quotes doubled,
+// any other field is copied as is.
+// Return 0 if all is good.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_csv_field(
+    String_Builder* const builder,
+    char const* const field,
+    size_t const length,
+    char const delimiter
+) {
+    assert(builder != NULL);
+    assert(field != NULL || length == 0);
+
+    char const specials[] = { delimiter, '"', '\n', '\r' };
+    size_t i = scan_find_any(field, length, specials, sizeof(specials));
+
+    if (i == length) {
+        return string_builder_write_bytes(builder, field, length);
+    }
+
+    if (string_builder_write_byte(builder, '"') || string_builder_write_bytes(builder, field, i)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    while (i < length) {
+        size_t const clean = scan_find_byte(field + i, length - i, '"');
+        if (string_builder_write_bytes(builder, field + i, clean)) {
+            return STRING_BUILDER_ERROR_SOME;
+        }
+        i += clean;
+
+        if (i < length) {
+            if (string_builder_write_bytes(builder, "\"\"", 2)) {
+                return STRING_BUILDER_ERROR_SOME;
+            }
+            i += 1;
+        }
+    }
+
+    return string_builder_write_byte(builder, '"');
+}
+
+// Write the bytes as a single POSIX shell word in single quotes.
+// A single quote is written as '\'' since nothing can be escaped inside single quotes.
+// Return 0 if all is good.
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_shell_arg(
+    String_Builder* const builder,
+    char const* const arg,
+    size_t const length
+) {
+    assert(builder != NULL);
+    assert(arg != NULL || length == 0);
+
+    if (string_builder_write_byte(builder, '\'')) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    size_t i = 0;
+
+    while (i < length) {
+        size_t const clean = scan_find_byte(arg + i, length - i, '\'');
+        if (string_builder_write_bytes(builder, arg + i, clean)) {
+            return STRING_BUILDER_ERROR_SOME;
+        }
+        i += clean;
+
+        if (i < length) {
+            if (string_builder_write_bytes(builder, "'\\''", 4)) {
+                return STRING_BUILDER_ERROR_SOME;
+            }
+            i += 1;
+        }
+    }
+
+    return string_builder_write_byte(builder, '\'');
+}
+
+//
+//  TYPED PRINTING
+//
+
+__attribute__((warn_unused_result))
+String_Builder_Error string_builder_write_bool(
+    String_Builder* const builder,
+    _Bool const value
+) {
+    return value
+        ? string_builder_write_bytes(builder, "true", 4)
+        : string_builder_write_bytes(builder, "false", 5);
+}
+
+// Typed printing picks the writers with _Generic, so it needs C11.
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+
+// Pick the writer for the static type of the value.
+#define LIBCHIMP_STRING_BUILDER_WRITE(builder, value) _Generic((value), \
+    _Bool: string_builder_write_bool,                                   \
+    char: string_builder_write_byte,                                    \
+    signed char: string_builder_write_int,                              \
+    short: string_builder_write_int,                                    \
+    int: string_builder_write_int,                                      \
+    long: string_builder_write_int,                                     \
+    long long: string_builder_write_int,                                \
+    unsigned char: string_builder_write_uint,                           \
+    unsigned short: string_builder_write_uint,                          \
+    unsigned int: string_builder_write_uint,                            \
+    unsigned long: string_builder_write_uint,                           \
+    unsigned long long: string_builder_write_uint,                      \
+    float: string_builder_write_f32,                                    \
+    double: string_builder_write_f64,                                   \
+    char*: string_builder_write_string,                                 \
+    char const*: string_builder_write_string,                           \
+    Str: string_builder_write_str                                       \
+)(builder, value)
+
+#define LIBCHIMP_STRING_BUILDER_PRINT_1(b, x) LIBCHIMP_STRING_BUILDER_WRITE(b, x)
+#define LIBCHIMP_STRING_BUILDER_PRINT_2(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_1(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_3(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_2(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_4(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_3(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_5(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_4(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_6(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_5(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_7(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_6(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_8(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_7(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_9(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_8(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_10(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_9(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_11(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_10(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_12(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_11(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_13(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_12(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_14(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_13(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_15(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_14(b, __VA_ARGS__))
+#define LIBCHIMP_STRING_BUILDER_PRINT_16(b, x, ...) (LIBCHIMP_STRING_BUILDER_WRITE(b, x) || LIBCHIMP_STRING_BUILDER_PRINT_15(b, __VA_ARGS__))
+
+#define LIBCHIMP_STRING_BUILDER_COUNT(...) LIBCHIMP_STRING_BUILDER_COUNT_N(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LIBCHIMP_STRING_BUILDER_COUNT_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, n, ...) n
+#define LIBCHIMP_STRING_BUILDER_CONCAT(a, b) LIBCHIMP_STRING_BUILDER_CONCAT_(a, b)
+#define LIBCHIMP_STRING_BUILDER_CONCAT_(a, b) a##b
+
+// Write up to 16 values, each with the writer for its static type.
+// There's no format string to parse at runtime and no varargs, and string literals
+// are measured at compile time once the writers are inlined.
+// Writing stops at the first error. The builder expression is evaluated once per value.
+// Only available in C11 and later, C99 code calls the writers directly.
+//
+// Usage:
+//     if (string_builder_print(&builder, "user ", id, " took ", seconds, "s\n")) {
+//         ...
+//     }
+#define string_builder_print(builder, ...) ((String_Builder_Error)(     \
+    LIBCHIMP_STRING_BUILDER_CONCAT(                                     \
+        LIBCHIMP_STRING_BUILDER_PRINT_,                                 \
+        LIBCHIMP_STRING_BUILDER_COUNT(__VA_ARGS__)                      \
+    )(builder, __VA_ARGS__)                                             \
+))
+
+#endif
+
 #endif
 
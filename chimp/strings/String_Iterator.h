@@ -5,6 +5,12 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "../scan.h"
+#include "Line_Index.h"
+#include "Str.h"
+#include "parse.h"
+#include "utf8.h"
+
 typedef struct String_Iterator_Position String_Iterator_Position;
 struct String_Iterator_Position {
     uint64_t offset;
@@ -18,6 +24,7 @@ struct String_Iterator {
     size_t const length;
     uint64_t offset;
     String_Iterator_Position position;
+    char is_utf8;
 };
 
 typedef struct String_Iterator_Result String_Iterator_Result;
@@ -26,6 +33,19 @@ struct String_Iterator_Result {
     int byte;
 };
 
+typedef struct String_Iterator_Code_Point String_Iterator_Code_Point;
+struct String_Iterator_Code_Point {
+    String_Iterator_Position position;
+    int32_t code_point;
+};
+
+typedef struct String_Iterator_Slice String_Iterator_Slice;
+struct String_Iterator_Slice {
+    String_Iterator_Position position;
+    char* string;
+    size_t length;
+};
+
 // Create a byte iterator.
 __attribute__((warn_unused_result))
 String_Iterator string_iterator_create(
@@ -39,9 +59,46 @@ String_Iterator string_iterator_create(
         .length = length,
         .offset = 0,
         .position = { .offset = 0, .line = 1, .column = 1 },
+        .is_utf8 = 0,
     };
 }
 
+// Create an iterator over UTF-8 text, with columns counted in code points instead of bytes.
+__attribute__((warn_unused_result))
+String_Iterator string_iterator_create_utf8(
+    char* const string,
+    size_t const length
+) {
+    String_Iterator iter = string_iterator_create(string, length);
+    iter.is_utf8 = 1;
+    return iter;
+}
+
+// Count the columns that the bytes take, which contain no newlines.
+__attribute__((warn_unused_result))
+size_t string_iterator_count_columns(
+    String_Iterator const* const iter,
+    char const* const data,
+    size_t const count
+) {
+    return iter->is_utf8 ? utf8_count_code_points(data, count) : count;
+}
+
+// View the bytes that haven't been read yet.
+__attribute__((warn_unused_result))
+Str string_iterator_rest(String_Iterator const* const iter) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(iter->offset <= iter->length);
+    return str_create(iter->string + iter->offset, iter->length - iter->offset);
+}
+
+// View the bytes of a slice.
+__attribute__((warn_unused_result))
+Str string_iterator_slice_str(String_Iterator_Slice const slice) {
+    return str_create(slice.string, slice.length);
+}
+
 // Read the next byte and increment the offset.
 __attribute__((warn_unused_result))
 String_Iterator_Result string_iterator_next(String_Iterator* const iter) {
@@ -63,6 +120,40 @@ String_Iterator_Result string_iterator_next(String_Iterator* const iter) {
         if (result.byte == '\n') {
             iter->position.line += 1;
             iter->position.column = 1;
+        } else if (!iter->is_utf8 || !utf8_is_continuation((char)result.byte)) {
+            iter->position.column += 1;
+        }
+    }
+
+    return result;
+}
+
+// Read the next code point and move past it.
+// An invalid sequence gives a code point of -1 and only its first byte is consumed.
+// The code point is 0 when the iterator has reached the end of the string.
+__attribute__((warn_unused_result))
+String_Iterator_Code_Point string_iterator_next_code_point(String_Iterator* const iter) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(iter->length > 0);
+    assert(iter->offset <= iter->length);
+
+    String_Iterator_Code_Point result = {
+        .position = iter->position,
+        .code_point = 0,
+    };
+
+    if (iter->offset < iter->length) {
+        uint32_t code_point = 0;
+        size_t const count = utf8_decode(iter->string + iter->offset, iter->length - iter->offset, &code_point);
+
+        result.code_point = count > 0 ? (int32_t)code_point : -1;
+        iter->offset += count > 0 ? count : 1;
+        iter->position.offset += count > 0 ? count : 1;
+
+        if (result.code_point == '\n') {
+            iter->position.line += 1;
+            iter->position.column = 1;
         } else {
             iter->position.column += 1;
         }
@@ -91,4 +182,236 @@ String_Iterator_Result string_iterator_peek(const String_Iterator* const iter) {
     return result;
 }
 
+// Skip count bytes, updating the line and column in bulk.
+void string_iterator_advance(
+    String_Iterator* const iter,
+    size_t const count
+) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(iter->offset + count <= iter->length);
+
+    char const* const start = iter->string + iter->offset;
+    size_t const newlines = scan_count_byte(start, count, '\n');
+
+    if (newlines > 0) {
+        size_t const last_newline = scan_find_last_byte(start, count, '\n');
+        iter->position.line += newlines;
+        iter->position.column = 1 + string_iterator_count_columns(iter, start + last_newline + 1, count - last_newline - 1);
+    } else {
+        iter->position.column += string_iterator_count_columns(iter, start, count);
+    }
+
+    iter->offset += count;
+    iter->position.offset += count;
+}
+
+// Read bytes until the delimiter or the end of the string.
+// The delimiter is not consumed.
+__attribute__((warn_unused_result))
+String_Iterator_Slice string_iterator_read_until(
+    String_Iterator* const iter,
+    char const delimiter
+) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(iter->length > 0);
+    assert(iter->offset <= iter->length);
+
+    String_Iterator_Slice const slice = {
+        .position = iter->position,
+        .string = iter->string + iter->offset,
+        .length = scan_find_byte(iter->string + iter->offset, iter->length - iter->offset, delimiter),
+    };
+
+    if (delimiter == '\n') {
+        // There can't be any newlines before the delimiter.
+        iter->offset += slice.length;
+        iter->position.offset += slice.length;
+        iter->position.column += string_iterator_count_columns(iter, slice.string, slice.length);
+    } else {
+        string_iterator_advance(iter, slice.length);
+    }
+
+    return slice;
+}
+
+// Read the next line without the newline.
+// The newline is consumed.
+// The slice is empty when the iterator has reached the end of the string.
+__attribute__((warn_unused_result))
+String_Iterator_Slice string_iterator_next_line(String_Iterator* const iter) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(iter->length > 0);
+    assert(iter->offset <= iter->length);
+
+    String_Iterator_Slice const slice = string_iterator_read_until(iter, '\n');
+
+    if (iter->offset < iter->length) {
+        iter->offset += 1;
+        iter->position.offset += 1;
+        iter->position.line += 1;
+        iter->position.column = 1;
+    }
+
+    return slice;
+}
+
+// Skip bytes as long as they belong to the byte class.
+// Return the number of bytes skipped.
+size_t string_iterator_skip_while(
+    String_Iterator* const iter,
+    Byte_Class const* const byte_class
+) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(iter->length > 0);
+    assert(iter->offset <= iter->length);
+    assert(byte_class != NULL);
+
+    size_t const count = scan_skip_class(iter->string + iter->offset, iter->length - iter->offset, byte_class);
+    string_iterator_advance(iter, count);
+
+    return count;
+}
+
+//
+//  OFFSET ONLY
+//
+
+// Read the next byte and increment the offset, without updating the position.
+// Use string_iterator_locate or string_iterator_sync_position to get the position when
+// it is needed, e.g. for an error message.
+// The byte is 0 at the end of the string.
+__attribute__((warn_unused_result))
+int string_iterator_next_byte(String_Iterator* const iter) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(iter->offset <= iter->length);
+
+    if (iter->offset == iter->length) {
+        return 0;
+    }
+
+    int const byte = iter->string[iter->offset];
+    iter->offset += 1;
+    return byte;
+}
+
+// Skip count bytes without updating the position.
+void string_iterator_skip(
+    String_Iterator* const iter,
+    size_t const count
+) {
+    assert(iter != NULL);
+    assert(iter->offset + count <= iter->length);
+    iter->offset += count;
+}
+
+// Get the position of any offset in the string.
+// The index is extended up to the offset the first time an offset past it is located,
+// so the string is scanned for newlines at most once.
+// The line and column are 0 if the index ran out of memory before the offset.
+__attribute__((warn_unused_result))
+String_Iterator_Position string_iterator_locate(
+    String_Iterator const* const iter,
+    Line_Index* const index,
+    uint64_t const offset
+) {
+    assert(iter != NULL);
+    assert(iter->string != NULL);
+    assert(index != NULL);
+    assert(offset <= iter->length);
+
+    if (offset > index->scanned) {
+        line_index_add(index, iter->string + index->scanned, offset - index->scanned);
+    }
+
+    Line_Index_Position const found = line_index_lookup(index, offset);
+    if (found.line == 0) {
+        return (String_Iterator_Position) { .offset = offset, .line = 0, .column = 0 };
+    }
+
+    return (String_Iterator_Position) {
+        .offset = offset,
+        .line = found.line,
+        .column = 1 + string_iterator_count_columns(iter, iter->string + found.line_start, offset - found.line_start),
+    };
+}
+
+// Bring the position up to date after offset-only reads.
+void string_iterator_sync_position(
+    String_Iterator* const iter,
+    Line_Index* const index
+) {
+    assert(iter != NULL);
+    iter->position = string_iterator_locate(iter, index, iter->offset);
+}
+
+//
+//  NUMBERS
+//
+
+// Move past the parsed bytes. Numbers never contain newlines, so only the column changes.
+void string_iterator_advance_number(
+    String_Iterator* const iter,
+    size_t const count
+) {
+    iter->offset += count;
+    iter->position.offset += count;
+    iter->position.column += count;
+}
+
+// Parse a signed integer at the current offset.
+// Return PARSE_ERROR_NONE if all is good, the number is consumed.
+// On error the iterator is moved to the offending byte, so its position tells where the error is.
+__attribute__((warn_unused_result))
+Parse_Error string_iterator_parse_i64(
+    String_Iterator* const iter,
+    int64_t* const value
+) {
+    assert(iter != NULL);
+    assert(iter->offset <= iter->length);
+
+    size_t consumed = 0;
+    Parse_Error const error = parse_i64(iter->string + iter->offset, iter->length - iter->offset, value, &consumed);
+    string_iterator_advance_number(iter, consumed);
+    return error;
+}
+
+// Parse an unsigned integer at the current offset.
+// Return PARSE_ERROR_NONE if all is good, the number is consumed.
+// On error the iterator is moved to the offending byte.
+__attribute__((warn_unused_result))
+Parse_Error string_iterator_parse_u64(
+    String_Iterator* const iter,
+    uint64_t* const value
+) {
+    assert(iter != NULL);
+    assert(iter->offset <= iter->length);
+
+    size_t consumed = 0;
+    Parse_Error const error = parse_u64(iter->string + iter->offset, iter->length - iter->offset, value, &consumed);
+    string_iterator_advance_number(iter, consumed);
+    return error;
+}
+
+// Parse a float at the current offset.
+// Return PARSE_ERROR_NONE if all is good, the number is consumed.
+// On error the iterator is moved to the offending byte.
+__attribute__((warn_unused_result))
+Parse_Error string_iterator_parse_f64(
+    String_Iterator* const iter,
+    double* const value
+) {
+    assert(iter != NULL);
+    assert(iter->offset <= iter->length);
+
+    size_t consumed = 0;
+    Parse_Error const error = parse_f64(iter->string + iter->offset, iter->length - iter->offset, value, &consumed);
+    string_iterator_advance_number(iter, consumed);
+    return error;
+}
+
 #endif
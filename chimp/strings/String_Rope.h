@@ -0,0 +1,254 @@
+#ifndef LIBCHIMP_STRING_ROPE_H
+#define LIBCHIMP_STRING_ROPE_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../mem/Arena.h"
+#include "String_Builder.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <errno.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #define LIBCHIMP_STRING_ROPE_WRITEV
+#endif
+
+// The most segments handed to a single writev call.
+#define LIBCHIMP_STRING_ROPE_IOV_COUNT 64
+
+typedef struct String_Rope_Segment String_Rope_Segment;
+struct String_Rope_Segment {
+    String_Rope_Segment* next;
+    char const* data;
+    size_t length;
+};
+
+// A string made of segments that are never copied once written.
+// The builder writes into a chunk taken from the arena. When a write doesn't fit,
+// the written part of the chunk becomes a segment and the builder moves on to a new
+// chunk. Outside buffers can be appended as segments as they are.
+// The rope must not be moved after it is created, and the builder buffer is not
+// NUL-terminated.
+//
+// Usage:
+//     String_Rope rope;
+//     if (string_rope_create(&rope, &arena, 4096)) { ... }
+//     if (string_builder_printf(&rope.builder, "%d items\n", count)) { ... }
+//     if (string_rope_write_segment(&rope, body, body_length)) { ... }
+//     if (string_rope_writev(&rope, fd)) { ... }
+typedef struct String_Rope String_Rope;
+struct String_Rope {
+    String_Builder builder;
+    Arena* arena;
+    String_Rope_Segment* head;
+    String_Rope_Segment* tail;
+    size_t segment_count;
+    size_t length;
+    size_t chunk_size;
+};
+
+// Append a segment without copying the data.
+// Return 0 if all is good.
+// Return STRING_BUILDER_ERROR_SOME if the arena has no room for the segment.
+__attribute__((warn_unused_result))
+String_Builder_Error string_rope_append(
+    String_Rope* const rope,
+    char const* const data,
+    size_t const length
+) {
+    assert(rope != NULL);
+    assert(data != NULL || length == 0);
+
+    if (length == 0) {
+        return STRING_BUILDER_ERROR_NONE;
+    }
+
+    String_Rope_Segment* const segment = arena_alloc_nozero(rope->arena, sizeof(String_Rope_Segment));
+    if (segment == NULL) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    segment->next = NULL;
+    segment->data = data;
+    segment->length = length;
+
+    if (rope->tail == NULL) {
+        rope->head = segment;
+    } else {
+        rope->tail->next = segment;
+    }
+
+    rope->tail = segment;
+    rope->segment_count += 1;
+    rope->length += length;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+// Turn the written part of the builder into a segment.
+// The builder keeps writing into the rest of the chunk.
+// Return 0 if all is good.
+__attribute__((warn_unused_result))
+String_Builder_Error string_rope_seal(String_Rope* const rope) {
+    assert(rope != NULL);
+
+    String_Builder* const builder = &rope->builder;
+
+    if (string_rope_append(rope, builder->buffer, builder->length)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    builder->buffer += builder->length;
+    builder->capacity -= builder->length;
+    builder->length = 0;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+// The grow hook of the rope builder: seal the chunk and take a new one.
+__attribute__((warn_unused_result))
+String_Builder_Error string_rope_grow(
+    String_Builder* const builder,
+    size_t const count
+) {
+    assert(builder != NULL);
+    assert(builder->context != NULL);
+
+    String_Rope* const rope = builder->context;
+
+    if (string_rope_seal(rope)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    size_t const size = count + 1 > rope->chunk_size ? count + 1 : rope->chunk_size;
+    char* const chunk = arena_alloc_nozero(rope->arena, size);
+    if (chunk == NULL) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    builder->buffer = chunk;
+    builder->capacity = size;
+    builder->length = 0;
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+// Create an empty rope that takes chunks of chunk_size bytes from the arena.
+// Return 0 if all is good.
+// Return STRING_BUILDER_ERROR_SOME if the arena has no room for the first chunk.
+__attribute__((warn_unused_result))
+String_Builder_Error string_rope_create(
+    String_Rope* const rope,
+    Arena* const arena,
+    size_t const chunk_size
+) {
+    assert(rope != NULL);
+    assert(arena != NULL);
+    assert(chunk_size > 1);
+
+    char* const chunk = arena_alloc_nozero(arena, chunk_size);
+    if (chunk == NULL) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    *rope = (String_Rope) {
+        .builder = {
+            .buffer = chunk,
+            .capacity = chunk_size,
+            .length = 0,
+            .grow = string_rope_grow,
+            .context = rope,
+        },
+        .arena = arena,
+        .head = NULL,
+        .tail = NULL,
+        .segment_count = 0,
+        .length = 0,
+        .chunk_size = chunk_size,
+    };
+
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+// Append an outside buffer without copying it.
+// The data must stay alive as long as the rope is used.
+// Return 0 if all is good.
+__attribute__((warn_unused_result))
+String_Builder_Error string_rope_write_segment(
+    String_Rope* const rope,
+    char const* const data,
+    size_t const length
+) {
+    assert(rope != NULL);
+
+    if (string_rope_seal(rope)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    return string_rope_append(rope, data, length);
+}
+
+// Get the total length of the rope, including the unsealed part of the builder.
+__attribute__((warn_unused_result))
+size_t string_rope_length(String_Rope const* const rope) {
+    assert(rope != NULL);
+    return rope->length + rope->builder.length;
+}
+
+#ifdef LIBCHIMP_STRING_ROPE_WRITEV
+
+// Write the whole rope to the file descriptor with as few writev calls as possible.
+// Return 0 if all is good.
+// Return STRING_BUILDER_ERROR_SOME if a write fails, errno tells why.
+__attribute__((warn_unused_result))
+String_Builder_Error string_rope_writev(
+    String_Rope* const rope,
+    int const fd
+) {
+    assert(rope != NULL);
+    assert(fd >= 0);
+
+    if (string_rope_seal(rope)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    String_Rope_Segment const* segment = rope->head;
+    size_t offset = 0;
+
+    while (segment != NULL) {
+        struct iovec vectors[LIBCHIMP_STRING_ROPE_IOV_COUNT];
+        int count = 0;
+
+        String_Rope_Segment const* next = segment;
+        size_t next_offset = offset;
+        while (next != NULL && count < LIBCHIMP_STRING_ROPE_IOV_COUNT) {
+            vectors[count].iov_base = (void*)(next->data + next_offset);
+            vectors[count].iov_len = next->length - next_offset;
+            count += 1;
+            next = next->next;
+            next_offset = 0;
+        }
+
+        ssize_t const written = writev(fd, vectors, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return STRING_BUILDER_ERROR_SOME;
+        }
+
+        // Skip what was written, a short write may end in the middle of a segment.
+        size_t remaining = (size_t)written;
+        while (segment != NULL && remaining >= segment->length - offset) {
+            remaining -= segment->length - offset;
+            segment = segment->next;
+            offset = 0;
+        }
+        offset += remaining;
+    }
+
+    return STRING_BUILDER_ERROR_NONE;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,327 @@
+/*
+    UTF-8 decoding, validation and counting.
+
+    Validation skips runs of ASCII with SIMD and decodes the rest one sequence at a
+    time, so mostly-ASCII text is checked at memory speed. Counting code points only
+    has to count the bytes that are not continuation bytes, which is done with SIMD
+    throughout. The SIMD variants follow scan.h: AVX2, then SSE2, then scalar.
+*/
+
+#ifndef LIBCHIMP_UTF8_H
+#define LIBCHIMP_UTF8_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../scan.h"
+
+// The code point that invalid sequences are usually replaced with.
+#define UTF8_REPLACEMENT 0xFFFD
+
+// Check whether the byte continues a multi-byte sequence.
+__attribute__((warn_unused_result))
+int utf8_is_continuation(char const byte) {
+    return ((uint8_t)byte & 0xC0) == 0x80;
+}
+
+// Decode the code point at the start of the data.
+// Overlong forms, surrogates, code points above U+10FFFF and truncated sequences are invalid.
+// Return the length of the sequence, 1 to 4.
+// Return 0 if the sequence is invalid, the code point is then set to UTF8_REPLACEMENT.
+__attribute__((warn_unused_result))
+size_t utf8_decode(
+    char const* const data,
+    size_t const length,
+    uint32_t* const code_point
+) {
+    assert(data != NULL);
+    assert(length > 0);
+    assert(code_point != NULL);
+
+    uint8_t const* const bytes = (uint8_t const*)data;
+    uint8_t const lead = bytes[0];
+
+    *code_point = UTF8_REPLACEMENT;
+
+    if (lead < 0x80) {
+        *code_point = lead;
+        return 1;
+    }
+
+    // The sequence length and the valid range of the second byte, which rules out
+    // overlong forms, surrogates and code points above U+10FFFF.
+    size_t count = 0;
+    uint8_t low = 0x80;
+    uint8_t high = 0xBF;
+    uint32_t value = 0;
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        count = 2;
+        value = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        count = 3;
+        value = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        count = 4;
+        value = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+
+    if (length < count || bytes[1] < low || bytes[1] > high) {
+        return 0;
+    }
+
+    for (size_t i = 1; i < count; i += 1) {
+        if ((bytes[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        value = (value << 6) | (bytes[i] & 0x3F);
+    }
+
+    *code_point = value;
+    return count;
+}
+
+// Encode the code point, which must not be a surrogate or above U+10FFFF.
+// The buffer must have room for 4 bytes.
+// Return the length of the sequence.
+__attribute__((warn_unused_result))
+size_t utf8_encode(
+    uint32_t const code_point,
+    char* const buffer
+) {
+    assert(buffer != NULL);
+    assert(code_point <= 0x10FFFF);
+    assert(code_point < 0xD800 || code_point > 0xDFFF);
+
+    if (code_point < 0x80) {
+        buffer[0] = (char)code_point;
+        return 1;
+    }
+    if (code_point < 0x800) {
+        buffer[0] = (char)(0xC0 | (code_point >> 6));
+        buffer[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    if (code_point < 0x10000) {
+        buffer[0] = (char)(0xE0 | (code_point >> 12));
+        buffer[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        buffer[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    buffer[0] = (char)(0xF0 | (code_point >> 18));
+    buffer[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    buffer[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    buffer[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+//
+//  SCALAR
+//
+
+__attribute__((warn_unused_result))
+size_t utf8_find_non_ascii_scalar(
+    char const* const data,
+    size_t const length
+) {
+    for (size_t i = 0; i < length; i += 1) {
+        if ((uint8_t)data[i] >= 0x80) {
+            return i;
+        }
+    }
+    return length;
+}
+
+__attribute__((warn_unused_result))
+size_t utf8_count_code_points_scalar(
+    char const* const data,
+    size_t const length
+) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i += 1) {
+        count += !utf8_is_continuation(data[i]);
+    }
+    return count;
+}
+
+//
+//  X86
+//
+
+#ifdef LIBCHIMP_SCAN_X86
+
+__attribute__((warn_unused_result))
+size_t utf8_find_non_ascii_sse2(
+    char const* const data,
+    size_t const length
+) {
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i const chunk = _mm_loadu_si128((__m128i const*)(data + i));
+        int const mask = _mm_movemask_epi8(chunk);
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+
+    return i + utf8_find_non_ascii_scalar(data + i, length - i);
+}
+
+__attribute__((warn_unused_result))
+size_t utf8_count_code_points_sse2(
+    char const* const data,
+    size_t const length
+) {
+    // As signed bytes, continuation bytes are the ones below -64.
+    __m128i const threshold = _mm_set1_epi8(-65);
+    __m128i const zero = _mm_setzero_si128();
+    size_t blocks = length / 16;
+    size_t count = 0;
+    size_t i = 0;
+
+    while (blocks > 0) {
+        // The per-lane byte counters overflow after 255 blocks.
+        size_t const n = blocks < 255 ? blocks : 255;
+        __m128i counters = zero;
+
+        for (size_t b = 0; b < n; b += 1, i += 16) {
+            __m128i const chunk = _mm_loadu_si128((__m128i const*)(data + i));
+            counters = _mm_sub_epi8(counters, _mm_cmpgt_epi8(chunk, threshold));
+        }
+
+        __m128i const sums = _mm_sad_epu8(counters, zero);
+        count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_extract_epi16(sums, 4);
+        blocks -= n;
+    }
+
+    return count + utf8_count_code_points_scalar(data + i, length - i);
+}
+
+__attribute__((warn_unused_result, target("avx2")))
+size_t utf8_find_non_ascii_avx2(
+    char const* const data,
+    size_t const length
+) {
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i const chunk = _mm256_loadu_si256((__m256i const*)(data + i));
+        unsigned const mask = (unsigned)_mm256_movemask_epi8(chunk);
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+
+    return i + utf8_find_non_ascii_sse2(data + i, length - i);
+}
+
+__attribute__((warn_unused_result, target("avx2")))
+size_t utf8_count_code_points_avx2(
+    char const* const data,
+    size_t const length
+) {
+    __m256i const threshold = _mm256_set1_epi8(-65);
+    __m256i const zero = _mm256_setzero_si256();
+    size_t blocks = length / 32;
+    size_t count = 0;
+    size_t i = 0;
+
+    while (blocks > 0) {
+        // The per-lane byte counters overflow after 255 blocks.
+        size_t const n = blocks < 255 ? blocks : 255;
+        __m256i counters = zero;
+
+        for (size_t b = 0; b < n; b += 1, i += 32) {
+            __m256i const chunk = _mm256_loadu_si256((__m256i const*)(data + i));
+            counters = _mm256_sub_epi8(counters, _mm256_cmpgt_epi8(chunk, threshold));
+        }
+
+        uint64_t sums[4];
+        _mm256_storeu_si256((__m256i*)sums, _mm256_sad_epu8(counters, zero));
+        count += (size_t)(sums[0] + sums[1] + sums[2] + sums[3]);
+        blocks -= n;
+    }
+
+    return count + utf8_count_code_points_sse2(data + i, length - i);
+}
+
+#endif
+
+//
+//  DISPATCH
+//
+
+// Find the first byte that is not ASCII.
+// Return the index of the byte, or length if all bytes are ASCII.
+__attribute__((warn_unused_result))
+size_t utf8_find_non_ascii(
+    char const* const data,
+    size_t const length
+) {
+    assert(data != NULL || length == 0);
+#ifdef LIBCHIMP_SCAN_X86
+    if (scan_has_avx2()) {
+        return utf8_find_non_ascii_avx2(data, length);
+    }
+    return utf8_find_non_ascii_sse2(data, length);
+#else
+    return utf8_find_non_ascii_scalar(data, length);
+#endif
+}
+
+// Count the code points, assuming the data is valid UTF-8.
+// Invalid bytes other than stray continuation bytes count as one code point each.
+__attribute__((warn_unused_result))
+size_t utf8_count_code_points(
+    char const* const data,
+    size_t const length
+) {
+    assert(data != NULL || length == 0);
+#ifdef LIBCHIMP_SCAN_X86
+    if (scan_has_avx2()) {
+        return utf8_count_code_points_avx2(data, length);
+    }
+    return utf8_count_code_points_sse2(data, length);
+#else
+    return utf8_count_code_points_scalar(data, length);
+#endif
+}
+
+// Validate the data as UTF-8.
+// Runs of ASCII are skipped with SIMD, other bytes are decoded one sequence at a time.
+// Return the index of the first invalid sequence, or length if the data is valid.
+__attribute__((warn_unused_result))
+size_t utf8_validate(
+    char const* const data,
+    size_t const length
+) {
+    assert(data != NULL || length == 0);
+
+    size_t i = 0;
+
+    while (i < length) {
+        i += utf8_find_non_ascii(data + i, length - i);
+
+        // Text that isn't ASCII tends to stay that way, so decode until the next ASCII byte.
+        while (i < length && (uint8_t)data[i] >= 0x80) {
+            uint32_t code_point = 0;
+            size_t const count = utf8_decode(data + i, length - i, &code_point);
+            if (count == 0) {
+                return i;
+            }
+            i += count;
+        }
+    }
+
+    return length;
+}
+
+#endif
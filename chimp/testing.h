@@ -1,6 +1,332 @@
 #ifndef LIBCHIMP_TESTING_H
 #define LIBCHIMP_TESTING_H
 
+//
+//  RUNNER
+//
+//  Tests are registered with TEST and run by testing_run.
+//  Every test runs in its own forked child, as many at a time as there are cores,
+//  so a crash or a hang only fails that test. The output of a test is captured
+//  and printed after its result line, so the output of parallel tests doesn't mix.
+//
+//  Usage:
+//      TEST(test_something) {
+//          assert_equal(1 + 1, 2);
+//          return 0;
+//      }
+//
+//      int main(int argc, char** argv) {
+//          return testing_run(__FILE__, argc, argv);
+//      }
+//
+//  The first argument, if any, runs only the tests whose name contains it.
+//
+
+// The runner needs fork, kill and the monotonic clock also with -std=c99 or -std=c11, which
+// hide them, and the headers under test need mmap extensions such as MAP_ANONYMOUS and madvise.
+// Feature macros only work before the first system header, so every test includes testing.h first.
+#if defined(__STRICT_ANSI__) && (defined(__unix__) || defined(__APPLE__))
+    #ifndef _DEFAULT_SOURCE
+        #define _DEFAULT_SOURCE
+    #endif
+    #ifndef _DARWIN_C_SOURCE
+        #define _DARWIN_C_SOURCE
+    #endif
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(LIBCHIMP_TESTING_NO_FORK) && (defined(__unix__) || defined(__APPLE__))
+    #define LIBCHIMP_TESTING_FORK
+    #include <signal.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+#ifndef LIBCHIMP_TESTING_MAX_TESTS
+    #define LIBCHIMP_TESTING_MAX_TESTS 1024
+#endif
+
+#ifndef LIBCHIMP_TESTING_MAX_JOBS
+    #define LIBCHIMP_TESTING_MAX_JOBS 64
+#endif
+
+// A test that runs longer than this is killed and fails.
+#ifndef LIBCHIMP_TESTING_TIMEOUT_SECONDS
+    #define LIBCHIMP_TESTING_TIMEOUT_SECONDS 10
+#endif
+
+// A test that runs longer than this passes, but is flagged as slow.
+#ifndef LIBCHIMP_TESTING_SLOW_MILLISECONDS
+    #define LIBCHIMP_TESTING_SLOW_MILLISECONDS 500
+#endif
+
+// Return 0 if the test passed.
+typedef int (*Testing_Function)(void);
+
+typedef struct Testing_Test Testing_Test;
+struct Testing_Test {
+    char const* name;
+    Testing_Function function;
+    int line;
+};
+
+Testing_Test testing_tests[LIBCHIMP_TESTING_MAX_TESTS];
+size_t testing_test_count = 0;
+
+// Define a test function and register it before main runs.
+#define TEST(name)                                                  \
+    int name(void);                                                 \
+    __attribute__((constructor)) static void name##_register(void) { \
+        testing_register(#name, name, __LINE__);                    \
+    }                                                               \
+    int name(void)
+
+// Add a test to the registry, keeping the tests in the order they were defined in.
+void testing_register(
+    char const* const name,
+    Testing_Function const function,
+    int const line
+) {
+    if (testing_test_count == LIBCHIMP_TESTING_MAX_TESTS) {
+        fprintf(stderr, "Too many tests, increase LIBCHIMP_TESTING_MAX_TESTS\n");
+        abort();
+    }
+
+    size_t index = testing_test_count;
+    while (index > 0 && testing_tests[index - 1].line > line) {
+        testing_tests[index] = testing_tests[index - 1];
+        index -= 1;
+    }
+
+    testing_tests[index] = (Testing_Test) {
+        .name = name,
+        .function = function,
+        .line = line,
+    };
+    testing_test_count += 1;
+}
+
+// Get the monotonic time in milliseconds.
+__attribute__((warn_unused_result))
+double testing_milliseconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e3 + (double)time.tv_nsec / 1e6;
+}
+
+// Print the result line of a test.
+// The result is NULL if the test passed.
+void testing_report(
+    Testing_Test const* const test,
+    char const* const result,
+    char const* const reason,
+    double const milliseconds
+) {
+    fprintf(
+        stderr,
+        "%s%s\033[0m %s (%.2f ms)%s%s\n",
+        result ? "\033[31m" : "\033[32m",
+        result ? result : "PASS",
+        test->name,
+        milliseconds,
+        reason ? ": " : "",
+        reason ? reason : ""
+    );
+    if (result == NULL && milliseconds > LIBCHIMP_TESTING_SLOW_MILLISECONDS) {
+        fprintf(stderr, "\033[33mSLOW\033[0m %s took over %d ms\n", test->name, LIBCHIMP_TESTING_SLOW_MILLISECONDS);
+    }
+}
+
+#ifdef LIBCHIMP_TESTING_FORK
+
+typedef struct Testing_Job Testing_Job;
+struct Testing_Job {
+    Testing_Test const* test;
+    FILE* output;
+    pid_t pid;
+    double start;
+    char is_timed_out;
+};
+
+// Copy the captured output of a finished test and close it.
+void testing_copy_output(FILE* const output) {
+    char buffer[4096];
+    size_t count = 0;
+
+    fflush(output);
+    rewind(output);
+    while ((count = fread(buffer, 1, sizeof(buffer), output)) > 0) {
+        fwrite(buffer, 1, count, stderr);
+    }
+    fclose(output);
+}
+
+// Run the test in a forked child with its output going to a temporary file.
+// Return 0 if all is good.
+// Return 1 if the child couldn't be started, the test is then run in this process.
+__attribute__((warn_unused_result))
+int testing_start(
+    Testing_Job* const job,
+    Testing_Test const* const test
+) {
+    *job = (Testing_Job) {
+        .test = test,
+        .output = tmpfile(),
+        .pid = -1,
+        .start = testing_milliseconds(),
+        .is_timed_out = 0,
+    };
+
+    if (job->output == NULL) {
+        return 1;
+    }
+
+    // Anything still buffered would be printed by the child too.
+    fflush(NULL);
+    job->pid = fork();
+
+    if (job->pid < 0) {
+        fclose(job->output);
+        return 1;
+    }
+
+    if (job->pid == 0) {
+        dup2(fileno(job->output), STDOUT_FILENO);
+        dup2(fileno(job->output), STDERR_FILENO);
+        // Keep what was printed before a crash.
+        setvbuf(stdout, NULL, _IONBF, 0);
+        int const result = test->function();
+        fflush(NULL);
+        _exit(result != 0);
+    }
+
+    return 0;
+}
+
+// Report a reaped child.
+// Return 0 if the test passed.
+__attribute__((warn_unused_result))
+int testing_finish(
+    Testing_Job* const job,
+    int const status
+) {
+    double const milliseconds = testing_milliseconds() - job->start;
+    int failed = 1;
+
+    if (job->is_timed_out) {
+        testing_report(job->test, "TIMEOUT", NULL, milliseconds);
+    } else if (WIFSIGNALED(status)) {
+        testing_report(job->test, "CRASH", strsignal(WTERMSIG(status)), milliseconds);
+    } else if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        testing_report(job->test, NULL, NULL, milliseconds);
+        failed = 0;
+    } else {
+        testing_report(job->test, "FAIL", NULL, milliseconds);
+    }
+
+    testing_copy_output(job->output);
+    job->test = NULL;
+    return failed;
+}
+
+#endif
+
+// Run a test in this process.
+// Return 0 if the test passed.
+__attribute__((warn_unused_result))
+int testing_run_serial(Testing_Test const* const test) {
+    double const start = testing_milliseconds();
+    int const failed = test->function() != 0;
+    testing_report(test, failed ? "FAIL" : NULL, NULL, testing_milliseconds() - start);
+    return failed;
+}
+
+// Run the registered tests and print a summary.
+// Return 0 if all tests passed, so the result can be returned from main.
+__attribute__((warn_unused_result))
+int testing_run(
+    char const* const file,
+    int const argc,
+    char** const argv
+) {
+    char const* const filter = argc > 1 ? argv[1] : NULL;
+    int failures = 0;
+
+#ifdef LIBCHIMP_TESTING_FORK
+    Testing_Job jobs[LIBCHIMP_TESTING_MAX_JOBS] = {0};
+    long const cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t const job_count = cores < 1 ? 1 : cores > LIBCHIMP_TESTING_MAX_JOBS ? LIBCHIMP_TESTING_MAX_JOBS : (size_t)cores;
+    size_t running = 0;
+    size_t next = 0;
+
+    while (next < testing_test_count || running > 0) {
+        // Fill the free slots.
+        for (size_t i = 0; i < job_count && next < testing_test_count; i += 1) {
+            if (jobs[i].test != NULL) {
+                continue;
+            }
+            Testing_Test const* const test = &testing_tests[next];
+            next += 1;
+            if (filter != NULL && strstr(test->name, filter) == NULL) {
+                continue;
+            }
+            if (testing_start(&jobs[i], test) != 0) {
+                jobs[i].test = NULL;
+                failures += testing_run_serial(test);
+                continue;
+            }
+            running += 1;
+        }
+
+        if (running == 0) {
+            continue;
+        }
+
+        int status = 0;
+        pid_t const pid = waitpid(-1, &status, WNOHANG);
+
+        if (pid > 0) {
+            for (size_t i = 0; i < job_count; i += 1) {
+                if (jobs[i].test != NULL && jobs[i].pid == pid) {
+                    failures += testing_finish(&jobs[i], status);
+                    running -= 1;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        double const now = testing_milliseconds();
+        for (size_t i = 0; i < job_count; i += 1) {
+            if (jobs[i].test != NULL && !jobs[i].is_timed_out && now - jobs[i].start > LIBCHIMP_TESTING_TIMEOUT_SECONDS * 1e3) {
+                kill(jobs[i].pid, SIGKILL);
+                jobs[i].is_timed_out = 1;
+            }
+        }
+
+        nanosleep(&(struct timespec) { .tv_sec = 0, .tv_nsec = 200000 }, NULL);
+    }
+#else
+    for (size_t i = 0; i < testing_test_count; i += 1) {
+        if (filter == NULL || strstr(testing_tests[i].name, filter) != NULL) {
+            failures += testing_run_serial(&testing_tests[i]);
+        }
+    }
+#endif
+
+    fprintf(
+        stderr,
+        "%s %sFailed tests: %d\n\033[0m",
+        file, failures ? "\033[31m" : "\033[32m", failures
+    );
+    return failures != 0;
+}
+
 #ifndef NDEBUG
 
     #include <stdio.h>
@@ -29,8 +355,8 @@
 
     #define assert_equal(actual, expected)                      \
         do {                                                    \
-            int64_t a = (int64_t)(actual);                      \
-            int64_t b = (int64_t)(expected);                    \
+            long long a = (long long)(actual);                  \
+            long long b = (long long)(expected);                \
             if (a != b) {                                       \
                 fprintf(                                        \
                     stderr,                                     \
@@ -0,0 +1,292 @@
+/*
+    Tracing of hot paths into per-thread ring buffers, exported as Chrome trace JSON
+    that can be opened in chrome://tracing or https://ui.perfetto.dev.
+
+    Every thread that traces registers its own buffer with trace_thread_begin. Only that
+    thread writes to the buffer, so recording an event is a time stamp and a few stores,
+    published with a release store of the head. When the ring is full, the oldest events
+    are overwritten. Threads without a buffer record nothing.
+
+    The macros compile to nothing when NDEBUG is defined, unless LIBCHIMP_TRACE is
+    defined too. Define LIBCHIMP_NO_TRACE to always compile them out.
+
+    Usage:
+        static Trace_Buffer buffer;
+        trace_thread_begin(&buffer, "main");
+
+        void parse(void) {
+            TRACE_ZONE("parse");
+            ...
+            TRACE_COUNTER("tokens", token_count);
+        }
+
+        String_Builder builder = string_builder_create_file(output, sizeof(output), file);
+        if (trace_write_json(&builder) || string_builder_flush(&builder)) { ... }
+*/
+
+#ifndef LIBCHIMP_TRACE_H
+#define LIBCHIMP_TRACE_H
+
+#if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L || defined(__STDC_NO_ATOMICS__)
+    #error "trace.h requires C11 atomics and thread-local storage"
+#endif
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "strings/String_Builder.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define LIBCHIMP_TRACE_RDTSC
+#endif
+
+#if (!defined(NDEBUG) || defined(LIBCHIMP_TRACE)) && !defined(LIBCHIMP_NO_TRACE)
+    #define LIBCHIMP_TRACE_ENABLED
+#endif
+
+// The number of events in each ring buffer, a power of two.
+#ifndef LIBCHIMP_TRACE_EVENTS
+    #define LIBCHIMP_TRACE_EVENTS (64 * 1024)
+#endif
+
+_Static_assert((LIBCHIMP_TRACE_EVENTS & (LIBCHIMP_TRACE_EVENTS - 1)) == 0, "LIBCHIMP_TRACE_EVENTS must be a power of two");
+
+typedef enum Trace_Event_Type {
+    TRACE_EVENT_BEGIN,
+    TRACE_EVENT_END,
+    TRACE_EVENT_COUNTER,
+} Trace_Event_Type;
+
+typedef struct Trace_Event Trace_Event;
+struct Trace_Event {
+    uint64_t ticks;
+    char const* name;
+    int64_t value;
+    Trace_Event_Type type;
+};
+
+// The events of one thread.
+// The buffer must stay alive until the trace has been written.
+typedef struct Trace_Buffer Trace_Buffer;
+struct Trace_Buffer {
+    Trace_Event events[LIBCHIMP_TRACE_EVENTS];
+    _Atomic uint64_t head;
+    Trace_Buffer* next;
+    char const* thread_name;
+    uint32_t thread_id;
+    uint64_t start_ticks;
+    uint64_t start_nanoseconds;
+};
+
+// All the registered buffers, newest first.
+_Atomic(Trace_Buffer*) trace_buffers = NULL;
+_Atomic uint32_t trace_thread_count = 0;
+
+// The buffer of the calling thread.
+_Thread_local Trace_Buffer* trace_thread_buffer = NULL;
+
+// Read the monotonic clock in nanoseconds.
+__attribute__((warn_unused_result))
+uint64_t trace_nanoseconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+}
+
+// Read the cheapest clock there is: the time stamp counter on x86, nanoseconds elsewhere.
+// The ticks are converted to time when the trace is written.
+__attribute__((warn_unused_result))
+uint64_t trace_ticks(void) {
+#ifdef LIBCHIMP_TRACE_RDTSC
+    return __rdtsc();
+#else
+    return trace_nanoseconds();
+#endif
+}
+
+// Start tracing the calling thread into the buffer.
+// The name is shown for the thread in the trace viewer and must outlive the buffer.
+void trace_thread_begin(
+    Trace_Buffer* const buffer,
+    char const* const thread_name
+) {
+    assert(buffer != NULL);
+    assert(thread_name != NULL);
+    assert(trace_thread_buffer == NULL);
+
+    atomic_store_explicit(&buffer->head, 0, memory_order_relaxed);
+    buffer->thread_name = thread_name;
+    buffer->thread_id = atomic_fetch_add_explicit(&trace_thread_count, 1, memory_order_relaxed) + 1;
+    buffer->start_nanoseconds = trace_nanoseconds();
+    buffer->start_ticks = trace_ticks();
+
+    Trace_Buffer* head = atomic_load_explicit(&trace_buffers, memory_order_relaxed);
+    do {
+        buffer->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&trace_buffers, &head, buffer, memory_order_release, memory_order_relaxed));
+
+    trace_thread_buffer = buffer;
+}
+
+// Stop tracing the calling thread. The events stay in the buffer for the export.
+void trace_thread_end(void) {
+    trace_thread_buffer = NULL;
+}
+
+// Record an event for the calling thread.
+void trace_record(
+    Trace_Event_Type const type,
+    char const* const name,
+    int64_t const value
+) {
+    Trace_Buffer* const buffer = trace_thread_buffer;
+    if (buffer == NULL) {
+        return;
+    }
+
+    uint64_t const head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    Trace_Event* const event = &buffer->events[head & (LIBCHIMP_TRACE_EVENTS - 1)];
+    event->ticks = trace_ticks();
+    event->name = name;
+    event->value = value;
+    event->type = type;
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+// Begin a zone that ends when the returned name goes out of scope, see TRACE_ZONE.
+__attribute__((warn_unused_result))
+char const* trace_zone_begin(char const* const name) {
+    trace_record(TRACE_EVENT_BEGIN, name, 0);
+    return name;
+}
+
+void trace_zone_end(char const* const* const name) {
+    trace_record(TRACE_EVENT_END, *name, 0);
+}
+
+#define LIBCHIMP_TRACE_CONCAT_(a, b) a##b
+#define LIBCHIMP_TRACE_CONCAT(a, b) LIBCHIMP_TRACE_CONCAT_(a, b)
+
+#ifdef LIBCHIMP_TRACE_ENABLED
+    // Trace the rest of the enclosing scope as a zone. The name must be a string that outlives the trace.
+    #define TRACE_ZONE(name) \
+        char const* const LIBCHIMP_TRACE_CONCAT(trace_zone_, __LINE__) __attribute__((cleanup(trace_zone_end), unused)) = trace_zone_begin(name)
+
+    // Begin and end a zone explicitly. Zones must nest.
+    #define TRACE_BEGIN(name) trace_record(TRACE_EVENT_BEGIN, (name), 0)
+    #define TRACE_END(name) trace_record(TRACE_EVENT_END, (name), 0)
+
+    // Record the value of a counter, shown as a graph in the trace viewer.
+    #define TRACE_COUNTER(name, value) trace_record(TRACE_EVENT_COUNTER, (name), (int64_t)(value))
+#else
+    #define TRACE_ZONE(name) ((void)0)
+    #define TRACE_BEGIN(name) ((void)0)
+    #define TRACE_END(name) ((void)0)
+    #define TRACE_COUNTER(name, value) ((void)0)
+#endif
+
+//
+//  EXPORT
+//
+
+// Write one event as a Chrome trace event object.
+__attribute__((warn_unused_result))
+String_Builder_Error trace_write_event(
+    String_Builder* const builder,
+    Trace_Buffer const* const buffer,
+    Trace_Event const* const event,
+    double const microseconds
+) {
+    char const* const phases[] = {
+        [TRACE_EVENT_BEGIN] = "B",
+        [TRACE_EVENT_END] = "E",
+        [TRACE_EVENT_COUNTER] = "C",
+    };
+
+    if (string_builder_write_string(builder, ",\n{\"name\":")
+        || string_builder_write_json_string(builder, event->name, strlen(event->name))
+        || string_builder_print(builder, ",\"ph\":\"", phases[event->type], "\",\"pid\":1,\"tid\":", buffer->thread_id, ",\"ts\":")
+        || string_builder_write_f64_fixed(builder, microseconds, 3)) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    if (event->type == TRACE_EVENT_COUNTER
+        && string_builder_print(builder, ",\"args\":{\"value\":", event->value, "}")) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    return string_builder_write_byte(builder, '}');
+}
+
+// Write the events of every registered buffer as Chrome trace JSON.
+// Zones whose beginning has been overwritten in the ring are left out. Events that are
+// overwritten while they are being written are skipped, but the trace is only
+// consistent if the traced threads are idle meanwhile.
+// Return 0 if all is good.
+__attribute__((warn_unused_result))
+String_Builder_Error trace_write_json(String_Builder* const builder) {
+    assert(builder != NULL);
+
+    Trace_Buffer const* const first = atomic_load_explicit(&trace_buffers, memory_order_acquire);
+
+    // Convert ticks to time over the longest interval there is, from the oldest buffer to now.
+    Trace_Buffer const* oldest = first;
+    for (Trace_Buffer const* buffer = first; buffer != NULL; buffer = buffer->next) {
+        oldest = buffer->start_nanoseconds < oldest->start_nanoseconds ? buffer : oldest;
+    }
+
+    uint64_t const end_nanoseconds = trace_nanoseconds();
+    uint64_t const end_ticks = trace_ticks();
+    double nanoseconds_per_tick = 1;
+    if (oldest != NULL && end_ticks > oldest->start_ticks) {
+        nanoseconds_per_tick = (double)(end_nanoseconds - oldest->start_nanoseconds) / (double)(end_ticks - oldest->start_ticks);
+    }
+
+    // The metadata event first, so that every event after it starts with a comma.
+    if (string_builder_write_string(builder, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"chimp\"}}")) {
+        return STRING_BUILDER_ERROR_SOME;
+    }
+
+    for (Trace_Buffer const* buffer = first; buffer != NULL; buffer = buffer->next) {
+        if (string_builder_print(builder, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":", buffer->thread_id, ",\"args\":{\"name\":")
+            || string_builder_write_json_string(builder, buffer->thread_name, strlen(buffer->thread_name))
+            || string_builder_write_string(builder, "}}")) {
+            return STRING_BUILDER_ERROR_SOME;
+        }
+
+        uint64_t const head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        uint64_t const start = head > LIBCHIMP_TRACE_EVENTS ? head - LIBCHIMP_TRACE_EVENTS : 0;
+        uint64_t depth = 0;
+
+        for (uint64_t i = start; i < head; i += 1) {
+            Trace_Event const event = buffer->events[i & (LIBCHIMP_TRACE_EVENTS - 1)];
+
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&buffer->head, memory_order_relaxed) - i > LIBCHIMP_TRACE_EVENTS) {
+                continue;
+            }
+
+            if (event.type == TRACE_EVENT_BEGIN) {
+                depth += 1;
+            } else if (event.type == TRACE_EVENT_END) {
+                if (depth == 0) {
+                    continue;
+                }
+                depth -= 1;
+            }
+
+            // Relative to the oldest buffer, so that the trace starts near 0.
+            double const nanoseconds = (double)(int64_t)(event.ticks - oldest->start_ticks) * nanoseconds_per_tick;
+            if (trace_write_event(builder, buffer, &event, nanoseconds / 1000)) {
+                return STRING_BUILDER_ERROR_SOME;
+            }
+        }
+    }
+
+    return string_builder_write_string(builder, "\n]}\n");
+}
+
+#endif
@@ -0,0 +1,289 @@
+#include "../chimp/testing.h"
+#include "../chimp/mem/Arena.h"
+#include "../chimp/mem/Chained_Arena.h"
+#include "../chimp/mem/Slice_Arena.h"
+#include "../chimp/mem/Virtual_Arena.h"
+
+#include <stdlib.h>
+
+TEST(test_alloc) {
+    uint8_t buffer[64] = {0};
+    Arena arena = arena_create(buffer, sizeof(buffer));
+
+    uint8_t* const first = arena_alloc(&arena, 8);
+    assert(first != NULL);
+    assert_equal(((uintptr_t)first) % (2 * sizeof(void*)), 0);
+
+    uint8_t* const second = arena_alloc(&arena, 8);
+    assert(second != NULL);
+    assert(second >= first + 8);
+
+    assert(arena_alloc(&arena, 128) == NULL);
+    return 0;
+}
+
+TEST(test_alloc_advances_past_padding) {
+    uint8_t buffer[64] = {0};
+    uint8_t* const unaligned = (uint8_t*)arena_align_forward((uintptr_t)buffer) + 1;
+    Arena arena = arena_create(unaligned, 48);
+
+    uint8_t* const first = arena_alloc(&arena, 4);
+    assert(first != NULL);
+    assert_equal(first - unaligned, 2 * sizeof(void*) - 1);
+    assert_equal(arena.offset, 2 * sizeof(void*) - 1 + 4);
+
+    uint8_t* const second = arena_alloc(&arena, 4);
+    assert(second != NULL);
+    assert(second >= first + 4);
+    return 0;
+}
+
+TEST(test_alloc_aligned) {
+    // Aligned so that the next 1024 byte boundary is past the end of the buffer.
+    uint8_t buffer[512] __attribute__((aligned(1024))) = {0};
+    Arena arena = arena_create(buffer, sizeof(buffer));
+
+    assert(arena_alloc(&arena, 1) != NULL);
+    uint8_t* const first = arena_alloc_aligned(&arena, 64, 64);
+    assert(first != NULL);
+    assert_equal((uintptr_t)first % 64, 0);
+
+    uint8_t* const second = arena_alloc_aligned(&arena, 1, 256);
+    assert(second != NULL);
+    assert_equal((uintptr_t)second % 256, 0);
+
+    assert(arena_alloc_aligned(&arena, 1, 1024) == NULL);
+    return 0;
+}
+
+TEST(test_alloc_nozero) {
+    uint8_t buffer[64] = {0};
+    Arena arena = arena_create(buffer, sizeof(buffer));
+
+    uint8_t* const first = arena_alloc(&arena, 8);
+    assert(first != NULL);
+    memset(first, 0xFF, 8);
+    arena_reset(&arena);
+
+    uint8_t* const second = arena_alloc_nozero(&arena, 8);
+    assert(second == first);
+    assert_equal(second[7], 0xFF);
+
+    arena_reset(&arena);
+    uint8_t* const third = arena_alloc(&arena, 8);
+    assert_equal(third[7], 0);
+    return 0;
+}
+
+TEST(test_realloc_last) {
+    uint8_t buffer[64] = {0};
+    Arena arena = arena_create(buffer, sizeof(buffer));
+
+    uint8_t* const first = arena_alloc(&arena, 8);
+    assert(first != NULL);
+    assert(arena_realloc_last(&arena, first, 8, 16) == first);
+    assert(arena_realloc_last(&arena, first, 16, 4) == first);
+
+    uint8_t* const second = arena_alloc(&arena, 8);
+    assert(second != NULL);
+    assert(arena_realloc_last(&arena, first, 4, 8) == NULL);
+    assert(arena_realloc_last(&arena, second, 8, 1024) == NULL);
+
+    uint64_t const offset = arena.offset;
+    assert(arena_realloc_last(&arena, second, 8, 64 - (second - buffer)) == second);
+    assert_equal(arena.offset, sizeof(buffer));
+    assert(offset < arena.offset);
+    assert(arena_alloc(&arena, 1) == NULL);
+    return 0;
+}
+
+TEST(test_mark_restore) {
+    uint8_t buffer[64] = {0};
+    Arena arena = arena_create(buffer, sizeof(buffer));
+
+    uint8_t* const first = arena_alloc(&arena, 8);
+    assert(first != NULL);
+
+    Arena_Mark const mark = arena_mark(&arena);
+    uint8_t* const second = arena_alloc(&arena, 8);
+    assert(second != NULL);
+    memset(second, 0xFF, 8);
+
+    arena_restore(&arena, mark);
+    assert_equal(arena.offset, mark.offset);
+
+    uint8_t* const third = arena_alloc(&arena, 8);
+    assert(third == second);
+    assert_equal(third[7], 0);
+    return 0;
+}
+
+TEST(test_clear_and_reset) {
+    uint8_t buffer[64] = {0};
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    buffer[63] = 0xAA;
+
+    uint8_t* const first = arena_alloc(&arena, 8);
+    assert(first != NULL);
+    memset(first, 0xFF, 8);
+
+    arena_clear(&arena);
+    assert_equal(arena.offset, 0);
+    assert_equal(first[0], 0);
+    assert_equal(buffer[63], 0xAA);
+
+    first[0] = 0xFF;
+    assert(arena_alloc(&arena, 8) != NULL);
+    arena_reset(&arena);
+    assert_equal(arena.offset, 0);
+    return 0;
+}
+
+TEST(test_clear_after_restore) {
+    uint8_t buffer[64] = {0};
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    buffer[63] = 0xAA;
+
+    Arena_Mark const mark = arena_mark(&arena);
+    uint8_t* const first = arena_alloc(&arena, 32);
+    assert(first != NULL);
+    memset(first, 0xFF, 32);
+
+    // The bytes given back are above the offset, but were used and must still be cleared.
+    arena_restore(&arena, mark);
+    uint8_t* const second = arena_alloc_nozero(&arena, 8);
+    assert(second != NULL);
+    assert(arena_realloc_last(&arena, second, 8, 4) != NULL);
+    arena_clear(&arena);
+    for (size_t i = 0; i < 32; i += 1) {
+        assert_equal(first[i], 0);
+    }
+    assert_equal(buffer[63], 0xAA);
+
+    uint8_t slice_buffer[64] = {0};
+    Slice_Arena slice_arena = slice_arena_create(slice_buffer, sizeof(slice_buffer));
+    Arena_Slice const slice = slice_arena_alloc(&slice_arena, 32);
+    assert(slice.pointer != NULL);
+    memset(slice.pointer, 0xFF, 32);
+    slice_arena_reset(&slice_arena);
+    slice_arena_clear(&slice_arena);
+    assert_equal(((uint8_t*)slice.pointer)[31], 0);
+    return 0;
+}
+
+size_t allocated_blocks = 0;
+
+void* test_allocator_alloc(void* const context, size_t const size) {
+    (void)context;
+    allocated_blocks += 1;
+    return malloc(size);
+}
+
+void test_allocator_free(void* const context, void* const pointer, size_t const size) {
+    (void)context;
+    (void)size;
+    allocated_blocks -= 1;
+    free(pointer);
+}
+
+Arena_Allocator const test_allocator = {
+    .alloc = test_allocator_alloc,
+    .free = test_allocator_free,
+    .context = NULL,
+};
+
+TEST(test_chained_alloc) {
+    Chained_Arena arena = chained_arena_create(test_allocator, 64);
+    assert_equal(allocated_blocks, 0);
+
+    uint8_t* const first = chained_arena_alloc(&arena, 32);
+    assert(first != NULL);
+    assert_equal(allocated_blocks, 1);
+    memset(first, 'a', 32);
+
+    uint8_t* const second = chained_arena_alloc(&arena, 48);
+    assert(second != NULL);
+    assert_equal(allocated_blocks, 2);
+    memset(second, 'b', 48);
+
+    // Bigger than a block, gets a block of its own.
+    uint8_t* const third = chained_arena_alloc(&arena, 1000);
+    assert(third != NULL);
+    assert_equal(allocated_blocks, 3);
+    assert_equal(third[999], 0);
+
+    assert_equal(first[31], 'a');
+    assert_equal(second[47], 'b');
+
+    chained_arena_destroy(&arena);
+    assert_equal(allocated_blocks, 0);
+    assert(arena.current == NULL);
+    return 0;
+}
+
+TEST(test_chained_mark_restore) {
+    Chained_Arena arena = chained_arena_create(test_allocator, 64);
+
+    Chained_Arena_Mark const empty = chained_arena_mark(&arena);
+    assert(chained_arena_alloc(&arena, 32) != NULL);
+
+    Chained_Arena_Mark const mark = chained_arena_mark(&arena);
+    uint8_t* const first = chained_arena_alloc(&arena, 8);
+    assert(first != NULL);
+    assert(chained_arena_alloc(&arena, 48) != NULL);
+    assert(chained_arena_alloc(&arena, 48) != NULL);
+    assert_equal(allocated_blocks, 3);
+
+    chained_arena_restore(&arena, mark);
+    assert_equal(allocated_blocks, 1);
+    assert(chained_arena_alloc(&arena, 8) == first);
+
+    assert(chained_arena_alloc(&arena, 48) != NULL);
+    chained_arena_reset(&arena);
+    assert_equal(allocated_blocks, 1);
+    assert_equal(arena.current->arena.offset, 0);
+
+    chained_arena_restore(&arena, empty);
+    assert_equal(allocated_blocks, 0);
+
+    chained_arena_destroy(&arena);
+    return 0;
+}
+
+TEST(test_virtual_alloc) {
+    size_t const reserve_size = (size_t)1 << 32;
+    Virtual_Arena arena = virtual_arena_create(reserve_size);
+    assert(arena.buffer != NULL);
+    assert(arena.reserved >= reserve_size);
+    assert_equal(arena.committed, 0);
+
+    uint8_t* const first = virtual_arena_alloc(&arena, 100);
+    assert(first != NULL);
+    assert_equal(arena.committed, LIBCHIMP_VIRTUAL_ARENA_COMMIT_SIZE);
+
+    size_t const big_size = 10 * 1024 * 1024;
+    uint8_t* const second = virtual_arena_alloc(&arena, big_size);
+    assert(second != NULL);
+    second[big_size - 1] = 1;
+    assert(arena.committed >= arena.offset);
+    assert(arena.committed < 2 * big_size);
+
+    assert(virtual_arena_alloc(&arena, arena.reserved) == NULL);
+
+    virtual_arena_reset(&arena);
+    assert(virtual_arena_alloc(&arena, 100) == first);
+
+    Virtual_Arena_Mark const mark = virtual_arena_mark(&arena);
+    uint8_t* const third = virtual_arena_alloc(&arena, 100);
+    assert(third != NULL);
+    virtual_arena_restore(&arena, mark);
+    assert(virtual_arena_alloc(&arena, 100) == third);
+
+    virtual_arena_destroy(&arena);
+    assert(arena.buffer == NULL);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,119 @@
+#include "../chimp/testing.h"
+#include "../chimp/mem/Atomic_Arena.h"
+
+#include <pthread.h>
+
+#define THREAD_COUNT 4
+#define ALLOCATIONS_PER_THREAD 1000
+
+TEST(test_alloc_until_full) {
+    uint8_t buffer[256];
+    Atomic_Arena arena = atomic_arena_create(buffer, sizeof(buffer));
+
+    size_t count = 0;
+    uint8_t* pointer = NULL;
+    while ((pointer = atomic_arena_alloc(&arena, 20)) != NULL) {
+        assert_equal((uintptr_t)pointer % LIBCHIMP_ATOMIC_ARENA_ALIGNMENT, 0);
+        assert_equal(pointer[19], 0);
+        memset(pointer, 0xFF, 20);
+        count += 1;
+    }
+
+    assert(count > 0);
+    assert(count * atomic_arena_round_up(20) <= arena.size);
+    assert(atomic_arena_alloc(&arena, 1) == NULL);
+
+    atomic_arena_reset(&arena);
+    pointer = atomic_arena_alloc(&arena, 20);
+    assert(pointer == arena.buffer);
+    assert_equal(pointer[0], 0);
+    return 0;
+}
+
+TEST(test_local) {
+    uint8_t buffer[1024];
+    Atomic_Arena arena = atomic_arena_create(buffer, sizeof(buffer));
+    Atomic_Arena_Local local = atomic_arena_local_create(&arena, 128);
+
+    uint8_t* const first = atomic_arena_local_alloc(&local, 8);
+    uint8_t* const second = atomic_arena_local_alloc(&local, 8);
+    assert(first != NULL && second != NULL);
+    assert(second == first + atomic_arena_round_up(8));
+    assert_equal(atomic_load(&arena.offset), 128);
+
+    // Too big for a chunk, so it comes straight from the shared arena.
+    uint8_t* const third = atomic_arena_local_alloc(&local, 100);
+    assert(third == arena.buffer + 128);
+    assert(local.buffer == first);
+    return 0;
+}
+
+typedef struct Worker Worker;
+struct Worker {
+    Atomic_Arena* arena;
+    uint64_t id;
+    int use_local;
+    uint64_t* pointers[ALLOCATIONS_PER_THREAD];
+};
+
+void* worker_run(void* const argument) {
+    Worker* const worker = argument;
+    Atomic_Arena_Local local = atomic_arena_local_create(worker->arena, 1024);
+
+    for (size_t i = 0; i < ALLOCATIONS_PER_THREAD; i += 1) {
+        uint64_t* const pointer = worker->use_local
+            ? atomic_arena_local_alloc(&local, 2 * sizeof(uint64_t))
+            : atomic_arena_alloc(worker->arena, 2 * sizeof(uint64_t));
+        if (pointer != NULL) {
+            pointer[0] = worker->id;
+            pointer[1] = i;
+        }
+        worker->pointers[i] = pointer;
+    }
+
+    return NULL;
+}
+
+// Every thread tags its allocations, so overlapping allocations would show up
+// as a tag written by another thread.
+int run_workers(int const use_local) {
+    static uint8_t buffer[THREAD_COUNT * ALLOCATIONS_PER_THREAD * 32 + 4096];
+    static Worker workers[THREAD_COUNT];
+    Atomic_Arena arena = atomic_arena_create(buffer, sizeof(buffer));
+    pthread_t threads[THREAD_COUNT];
+
+    for (uint64_t t = 0; t < THREAD_COUNT; t += 1) {
+        workers[t].arena = &arena;
+        workers[t].id = t;
+        workers[t].use_local = use_local;
+        int const status = pthread_create(&threads[t], NULL, worker_run, &workers[t]);
+        assert(status == 0);
+        (void)status;
+    }
+    for (size_t t = 0; t < THREAD_COUNT; t += 1) {
+        pthread_join(threads[t], NULL);
+    }
+
+    for (uint64_t t = 0; t < THREAD_COUNT; t += 1) {
+        for (size_t i = 0; i < ALLOCATIONS_PER_THREAD; i += 1) {
+            uint64_t const* const pointer = workers[t].pointers[i];
+            assert(pointer != NULL);
+            assert_equal(pointer[0], t);
+            assert_equal(pointer[1], i);
+        }
+    }
+
+    return 0;
+}
+
+TEST(test_threads_shared) {
+    return run_workers(0);
+}
+
+TEST(test_threads_local) {
+    return run_workers(1);
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
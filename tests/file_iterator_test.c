@@ -0,0 +1,146 @@
+// A tiny block buffer makes every test cross refills.
+#define LIBCHIMP_FILE_ITERATOR_BUFFER_SIZE 3
+
+#include "../chimp/testing.h"
+#include "../chimp/io/File_Iterator.h"
+
+#include <unistd.h>
+
+FILE* create_file(char* const contents, size_t const length) {
+    FILE* file = tmpfile();
+    if (file != NULL) {
+        fwrite(contents, 1, length, file);
+        rewind(file);
+    }
+    return file;
+}
+
+TEST(test_next) {
+    FILE* file = create_file("ab\ncd\n", 6);
+    assert(file != NULL);
+
+    File_Iterator iter = file_iterator_create(file);
+    char const expected_bytes[] = "ab\ncd\n";
+    uint64_t const expected_lines[] = { 1, 1, 1, 2, 2, 2 };
+    uint64_t const expected_columns[] = { 1, 2, 3, 1, 2, 3 };
+
+    for (int i = 0; i < 6; i += 1) {
+        File_Iterator_Result const result = file_iterator_next(&iter);
+        assert_equal(result.byte, expected_bytes[i]);
+        assert_equal(result.position.offset, i);
+        assert_equal(result.position.line, expected_lines[i]);
+        assert_equal(result.position.column, expected_columns[i]);
+    }
+
+    File_Iterator_Result const result = file_iterator_next(&iter);
+    assert_equal(result.byte, 0);
+    assert_equal(result.position.offset, 6);
+    assert_equal(result.position.line, 3);
+    assert_equal(result.position.column, 1);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_peek) {
+    FILE* file = create_file("abcd", 4);
+    assert(file != NULL);
+
+    File_Iterator iter = file_iterator_create(file);
+    for (int i = 0; i < 4; i += 1) {
+        File_Iterator_Result const peeked = file_iterator_peek(&iter);
+        File_Iterator_Result const result = file_iterator_next(&iter);
+        assert_equal(peeked.byte, 'a' + i);
+        assert_equal(result.byte, 'a' + i);
+        assert_equal(peeked.position.offset, result.position.offset);
+    }
+    assert_equal(file_iterator_peek(&iter).byte, 0);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_peek_pipe) {
+    int fds[2];
+    assert_equal(pipe(fds), 0);
+    assert_equal(write(fds[1], "xy", 2), 2);
+    close(fds[1]);
+
+    FILE* file = fdopen(fds[0], "r");
+    assert(file != NULL);
+
+    File_Iterator iter = file_iterator_create(file);
+    assert_equal(file_iterator_peek(&iter).byte, 'x');
+    assert_equal(file_iterator_next(&iter).byte, 'x');
+    assert_equal(file_iterator_peek(&iter).byte, 'y');
+    assert_equal(file_iterator_next(&iter).byte, 'y');
+    assert_equal(file_iterator_peek(&iter).byte, 0);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_high_bytes) {
+    char contents[] = { (char)0xC3, (char)0xA4 };
+    FILE* file = create_file(contents, sizeof(contents));
+    assert(file != NULL);
+
+    File_Iterator iter = file_iterator_create(file);
+    assert_equal(file_iterator_peek(&iter).byte, 0xC3);
+    assert_equal(file_iterator_next(&iter).byte, 0xC3);
+    assert_equal(file_iterator_next(&iter).byte, 0xA4);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_read_line) {
+    FILE* file = create_file("first\n\nthird", 12);
+    assert(file != NULL);
+
+    File_Iterator iter = file_iterator_create(file);
+    char output[16] = {0};
+
+    assert_equal(file_iterator_read_line(&iter, output, sizeof(output)), 6);
+    assert_equal(strncmp(output, "first\n", 6), 0);
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 1);
+
+    assert_equal(file_iterator_read_line(&iter, output, sizeof(output)), 1);
+    assert_equal(iter.position.line, 3);
+
+    assert_equal(file_iterator_read_line(&iter, output, sizeof(output)), 5);
+    assert_equal(strncmp(output, "third", 5), 0);
+    assert_equal(iter.position.offset, 12);
+    assert_equal(iter.position.column, 6);
+
+    assert_equal(file_iterator_read_line(&iter, output, sizeof(output)), 0);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_read_until_and_skip_while) {
+    FILE* file = create_file("  \n\t key=value", 14);
+    assert(file != NULL);
+
+    File_Iterator iter = file_iterator_create(file);
+    Byte_Class const whitespace = byte_class_create(" \t\n");
+    char output[16] = {0};
+
+    assert_equal(file_iterator_skip_while(&iter, &whitespace), 5);
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 3);
+
+    assert_equal(file_iterator_read_until(&iter, '=', output, sizeof(output)), 3);
+    assert_equal_string(output, "key");
+    assert_equal(file_iterator_next(&iter).byte, '=');
+    assert_equal(iter.position.column, 7);
+
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,192 @@
+#include "../chimp/testing.h"
+#include "../chimp/io/File_Reader.h"
+
+FILE* create_file(char* const contents, size_t const length) {
+    FILE* file = tmpfile();
+    if (file != NULL) {
+        fwrite(contents, 1, length, file);
+        rewind(file);
+    }
+    return file;
+}
+
+TEST(test_read_byte) {
+    FILE* file = create_file("abc", 3);
+    assert(file != NULL);
+
+    char buffer[2] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+    assert_equal(file_reader_read_byte(&reader), 'a');
+    assert_equal(file_reader_read_byte(&reader), 'b');
+    assert_equal(file_reader_read_byte(&reader), 'c');
+    assert_equal(file_reader_read_byte(&reader), EOF);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_read_bytes_through_buffer) {
+    FILE* file = create_file("hello world", 11);
+    assert(file != NULL);
+
+    char buffer[4] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+
+    char output[16] = {0};
+    assert_equal(file_reader_read_bytes(&reader, output, 3), 3);
+    assert_equal(file_reader_read_bytes(&reader, output + 3, 3), 3);
+    assert_equal(file_reader_read_bytes(&reader, output + 6, 10), 5);
+    assert_equal_string(output, "hello world");
+    assert_equal(file_reader_read_bytes(&reader, output, 3), 0);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_read_bytes_bypass_buffer) {
+    FILE* file = create_file("hello world", 11);
+    assert(file != NULL);
+
+    char buffer[4] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+
+    char output[16] = {0};
+    assert_equal(file_reader_read_byte(&reader), 'h');
+    assert_equal(file_reader_read_bytes(&reader, output, 8), 8);
+    assert_equal_string(output, "ello wor");
+    assert_equal(file_reader_read_byte(&reader), 'l');
+    assert_equal(file_reader_read_byte(&reader), 'd');
+    assert_equal(file_reader_read_byte(&reader), EOF);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_read_bytes_high_bytes) {
+    char contents[] = { 'a', (char)0xFF, 'b' };
+    FILE* file = create_file(contents, sizeof(contents));
+    assert(file != NULL);
+
+    char buffer[8] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+
+    char output[4] = {0};
+    assert_equal(file_reader_read_bytes(&reader, output, sizeof(output)), 3);
+    assert_equal(memcmp(output, contents, sizeof(contents)), 0);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_peek) {
+    FILE* file = create_file("ab", 2);
+    assert(file != NULL);
+
+    char buffer[1] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+    assert_equal(file_reader_peek(&reader), 'a');
+    assert_equal(file_reader_peek(&reader), 'a');
+    assert_equal(file_reader_read_byte(&reader), 'a');
+    assert_equal(file_reader_peek(&reader), 'b');
+    assert_equal(file_reader_read_byte(&reader), 'b');
+    assert_equal(file_reader_peek(&reader), EOF);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_peek_n) {
+    FILE* file = create_file("abcdefghij", 10);
+    assert(file != NULL);
+
+    char buffer[4] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+    char* window = NULL;
+
+    assert_equal(file_reader_read_byte(&reader), 'a');
+    assert_equal(file_reader_read_byte(&reader), 'b');
+    assert_equal(file_reader_read_byte(&reader), 'c');
+
+    // Only "d" is buffered, the rest of the window needs a refill.
+    assert_equal(file_reader_peek_n(&reader, 4, &window), 4);
+    assert_equal(strncmp(window, "defg", 4), 0);
+    assert_equal(file_reader_peek_n(&reader, 2, &window), 2);
+    assert_equal(strncmp(window, "de", 2), 0);
+
+    assert_equal(file_reader_skip(&reader, 2), 2);
+    assert_equal(file_reader_read_byte(&reader), 'f');
+
+    assert_equal(file_reader_peek_n(&reader, 4, &window), 4);
+    assert_equal(strncmp(window, "ghij", 4), 0);
+    assert_equal(file_reader_skip(&reader, 3), 3);
+    assert_equal(file_reader_peek_n(&reader, 4, &window), 1);
+    assert_equal(window[0], 'j');
+    assert_equal(file_reader_skip(&reader, 4), 1);
+    assert_equal(file_reader_peek_n(&reader, 4, &window), 0);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_read_until) {
+    FILE* file = create_file("key=value;", 10);
+    assert(file != NULL);
+
+    char buffer[4] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+
+    char output[16] = {0};
+    assert_equal(file_reader_read_until(&reader, '=', output, sizeof(output)), 3);
+    assert_equal_string(output, "key");
+    assert_equal(file_reader_read_byte(&reader), '=');
+
+    memset(output, 0, sizeof(output));
+    assert_equal(file_reader_read_until(&reader, ';', output, 2), 2);
+    assert_equal(file_reader_read_until(&reader, ';', output + 2, sizeof(output) - 2), 3);
+    assert_equal_string(output, "value");
+    assert_equal(file_reader_read_until(&reader, ';', output, sizeof(output)), 0);
+    assert_equal(file_reader_read_byte(&reader), ';');
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_read_line) {
+    FILE* file = create_file("first\n\nthird", 12);
+    assert(file != NULL);
+
+    char buffer[4] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+
+    char output[16] = {0};
+    assert_equal(file_reader_read_line(&reader, output, sizeof(output)), 6);
+    assert_equal(strncmp(output, "first\n", 6), 0);
+    assert_equal(file_reader_read_line(&reader, output, sizeof(output)), 1);
+    assert_equal(output[0], '\n');
+    assert_equal(file_reader_read_line(&reader, output, sizeof(output)), 5);
+    assert_equal(strncmp(output, "third", 5), 0);
+    assert_equal(file_reader_read_line(&reader, output, sizeof(output)), 0);
+
+    fclose(file);
+    return 0;
+}
+
+TEST(test_skip_while) {
+    FILE* file = create_file("   \t\n  x", 8);
+    assert(file != NULL);
+
+    char buffer[2] = {0};
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+    Byte_Class const whitespace = byte_class_create(" \t\n");
+
+    assert_equal(file_reader_skip_while(&reader, &whitespace), 7);
+    assert_equal(file_reader_read_byte(&reader), 'x');
+    assert_equal(file_reader_skip_while(&reader, &whitespace), 0);
+
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,193 @@
+#include "../chimp/testing.h"
+#include "../chimp/containers/Hash_Map.h"
+
+HASH_MAP_DEFINE(U64_Map, u64_map, uint64_t, uint64_t, hash_map_hash_u64, hash_map_equal_u64)
+HASH_MAP_DEFINE(Str_Map, str_map, Str, int, hash_map_hash_str, str_equal)
+
+// The hashes of the keys below 128 << 7 all start the probe at the first group,
+// so the probes have to go past full groups.
+uint64_t collide(uint64_t const key) {
+    return (key >> 7) & 0x7F;
+}
+
+HASH_MAP_DEFINE(Collide_Map, collide_map, uint64_t, uint64_t, collide, hash_map_equal_u64)
+
+TEST(test_insert_find) {
+    // Enough for the table to double up to 2048 slots, with the old tables left behind.
+    uint8_t buffer[1 << 17];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    U64_Map map = u64_map_create(&arena);
+
+    assert(u64_map_find(&map, 1) == NULL);
+    assert_equal(u64_map_erase(&map, 1), 0);
+
+    for (uint64_t i = 0; i < 1000; i += 1) {
+        assert_equal(u64_map_insert(&map, i * 7, i), 0);
+    }
+    assert_equal(map.table.count, 1000);
+    assert_equal(map.table.capacity, 2048);
+
+    for (uint64_t i = 0; i < 1000; i += 1) {
+        uint64_t const* const value = u64_map_find(&map, i * 7);
+        assert(value != NULL);
+        assert_equal(*value, i);
+        assert(u64_map_find(&map, i * 7 + 1) == NULL);
+    }
+
+    // Inserting an existing key replaces the value.
+    assert_equal(u64_map_insert(&map, 14, 100), 0);
+    uint64_t const* const replaced = u64_map_find(&map, 14);
+    assert(replaced != NULL);
+    assert_equal(*replaced, 100);
+    assert_equal(map.table.count, 1000);
+    return 0;
+}
+
+TEST(test_erase_iterate) {
+    uint8_t buffer[1 << 16];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    U64_Map map = u64_map_create(&arena);
+
+    for (uint64_t i = 0; i < 500; i += 1) {
+        assert_equal(u64_map_insert(&map, i, i * 2), 0);
+    }
+    for (uint64_t i = 0; i < 500; i += 2) {
+        assert_equal(u64_map_erase(&map, i), 1);
+    }
+    assert_equal(u64_map_erase(&map, 0), 0);
+    assert_equal(map.table.count, 250);
+
+    uint64_t sum = 0;
+    size_t count = 0;
+    size_t index = 0;
+    U64_Map_Entry* entry;
+    while (u64_map_next(&map, &index, &entry)) {
+        assert_equal(entry->key % 2, 1);
+        assert_equal(entry->value, entry->key * 2);
+        sum += entry->key;
+        count += 1;
+    }
+    assert_equal(count, 250);
+    assert_equal(sum, 250 * 250);
+
+    u64_map_clear(&map);
+    assert_equal(map.table.count, 0);
+    assert(u64_map_find(&map, 1) == NULL);
+    return 0;
+}
+
+TEST(test_str_keys) {
+    uint8_t buffer[4096];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    Str_Map map = str_map_create(&arena);
+
+    Str_Split split = str_split(STR_LITERAL("the cat and the dog and the bird"), ' ');
+    Str word;
+    while (str_split_next(&split, &word)) {
+        int* const count = str_map_find(&map, word);
+        if (count != NULL) {
+            *count += 1;
+        } else {
+            assert_equal(str_map_insert(&map, word, 1), 0);
+        }
+    }
+
+    assert_equal(map.table.count, 5);
+    char const* const words[] = { "the", "and", "bird" };
+    int const counts[] = { 3, 2, 1 };
+    for (size_t i = 0; i < 3; i += 1) {
+        int const* const count = str_map_find(&map, str_from_cstring(words[i]));
+        assert(count != NULL);
+        assert_equal(*count, counts[i]);
+    }
+    assert(str_map_find(&map, STR_LITERAL("th")) == NULL);
+    return 0;
+}
+
+TEST(test_collisions) {
+    uint8_t buffer[1 << 14];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    Collide_Map map = collide_map_create(&arena);
+
+    assert_equal(collide_map_reserve(&map, 100), 0);
+    assert_equal(map.table.capacity, 128);
+
+    // The first group fills up and the rest go to the following groups.
+    for (uint64_t i = 0; i < 100; i += 1) {
+        assert_equal(collide_map_insert(&map, i << 7, i), 0);
+    }
+    assert_equal(map.table.capacity, 128);
+
+    for (uint64_t i = 0; i < 100; i += 3) {
+        assert_equal(collide_map_erase(&map, i << 7), 1);
+    }
+    for (uint64_t i = 0; i < 100; i += 1) {
+        uint64_t const* const value = collide_map_find(&map, i << 7);
+        if (i % 3 == 0) {
+            assert(value == NULL);
+        } else {
+            assert(value != NULL);
+            assert_equal(*value, i);
+        }
+    }
+    return 0;
+}
+
+TEST(test_buffer) {
+    uint8_t buffer[1024];
+    U64_Map map = u64_map_create_buffer(buffer, sizeof(buffer));
+    assert_equal(map.table.capacity, 32);
+    assert_equal(hash_map_max_load(map.table.capacity), 28);
+
+    for (uint64_t i = 0; i < 28; i += 1) {
+        assert_equal(u64_map_insert(&map, i, i), 0);
+    }
+    assert_equal(u64_map_insert(&map, 28, 28), 1);
+    assert_equal(u64_map_reserve(&map, 29), 1);
+    assert_equal(u64_map_insert(&map, 27, 0), 0);
+
+    // Erasing and inserting new keys forever leaves tombstones, which are cleared by
+    // rehashing in place because the buffer can't grow.
+    for (uint64_t i = 28; i < 10000; i += 1) {
+        assert_equal(u64_map_erase(&map, i - 28), 1);
+        assert_equal(u64_map_insert(&map, i, i), 0);
+    }
+    assert_equal(map.table.count, 28);
+    for (uint64_t i = 10000 - 28; i < 10000; i += 1) {
+        uint64_t const* const value = u64_map_find(&map, i);
+        assert(value != NULL);
+        assert_equal(*value, i);
+    }
+
+    uint8_t tiny[64];
+    U64_Map tiny_map = u64_map_create_buffer(tiny, sizeof(tiny));
+    assert_equal(tiny_map.table.capacity, 0);
+    assert(u64_map_find(&tiny_map, 1) == NULL);
+    assert_equal(u64_map_insert(&tiny_map, 1, 1), 1);
+    return 0;
+}
+
+TEST(test_arena_full) {
+    uint8_t buffer[2048];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    U64_Map map = u64_map_create(&arena);
+
+    uint64_t i = 0;
+    while (u64_map_insert(&map, i, i) == 0) {
+        i += 1;
+    }
+
+    // A failed grow leaves the map as it was.
+    assert_equal(map.table.count, i);
+    assert_equal(i, 56);
+    for (uint64_t key = 0; key < i; key += 1) {
+        uint64_t const* const value = u64_map_find(&map, key);
+        assert(value != NULL);
+        assert_equal(*value, key);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,114 @@
+#include "../chimp/testing.h"
+#include "../chimp/strings/Line_Index.h"
+#include "../chimp/strings/String_Iterator.h"
+#include "../chimp/io/File_Iterator.h"
+
+TEST(test_lookup) {
+    uint8_t memory[4096];
+    Arena arena = arena_create(memory, sizeof(memory));
+    Line_Index index = line_index_create(&arena);
+
+    // Blocks may split lines anywhere.
+    assert_equal(line_index_add(&index, "ab\ncd", 5), 0);
+    assert_equal(line_index_add(&index, "\n\nef", 4), 0);
+    assert_equal(index.count, 3);
+    assert_equal(index.scanned, 9);
+
+    uint64_t const expected_lines[] = { 1, 1, 1, 2, 2, 2, 3, 4, 4, 4 };
+    uint64_t const expected_starts[] = { 0, 0, 0, 3, 3, 3, 6, 7, 7, 7 };
+    for (uint64_t offset = 0; offset <= 9; offset += 1) {
+        Line_Index_Position const found = line_index_lookup(&index, offset);
+        assert_equal(found.line, expected_lines[offset]);
+        assert_equal(found.line_start, expected_starts[offset]);
+    }
+
+    assert_equal(line_index_lookup(&index, 10).line, 0);
+    return 0;
+}
+
+TEST(test_growth) {
+    uint8_t memory[1536];
+    Arena arena = arena_create(memory, sizeof(memory));
+    Line_Index index = line_index_create(&arena);
+
+    // Room for 64 and then 128 offsets, but not 256.
+    char lines[400];
+    memset(lines, '\n', sizeof(lines));
+    assert_equal(line_index_add(&index, lines, sizeof(lines)), 1);
+    assert(index.is_full);
+    assert_equal(index.count, 128);
+    assert_equal(index.scanned, 128);
+    assert_equal(line_index_lookup(&index, 128).line, 129);
+    assert_equal(line_index_lookup(&index, 129).line, 0);
+    assert_equal(line_index_add(&index, "x", 1), 1);
+    return 0;
+}
+
+TEST(test_string_iterator) {
+    uint8_t memory[1024];
+    Arena arena = arena_create(memory, sizeof(memory));
+    Line_Index index = line_index_create(&arena);
+
+    char string[] = "one\ntw\xC3\xB6\nthree";
+    String_Iterator iter = string_iterator_create_utf8(string, strlen(string));
+
+    size_t count = 0;
+    while (string_iterator_next_byte(&iter) != 0) {
+        count += 1;
+    }
+    assert_equal(count, strlen(string));
+    assert_equal(iter.position.line, 1);
+    assert_equal(iter.position.column, 1);
+
+    String_Iterator_Position position = string_iterator_locate(&iter, &index, 7);
+    assert_equal(position.line, 2);
+    assert_equal(position.column, 4);
+    assert_equal(index.scanned, 7);
+
+    string_iterator_sync_position(&iter, &index);
+    assert_equal(iter.position.offset, strlen(string));
+    assert_equal(iter.position.line, 3);
+    assert_equal(iter.position.column, 6);
+
+    // Looking back doesn't scan again.
+    position = string_iterator_locate(&iter, &index, 2);
+    assert_equal(position.line, 1);
+    assert_equal(position.column, 3);
+    assert_equal(index.scanned, strlen(string));
+    return 0;
+}
+
+TEST(test_file_iterator) {
+    uint8_t memory[16384];
+    Arena arena = arena_create(memory, sizeof(memory));
+    Line_Index index = line_index_create(&arena);
+
+    FILE* const file = tmpfile();
+    assert(file != NULL);
+    for (int i = 0; i < 1000; i += 1) {
+        fputs("line\n", file);
+    }
+    fputs("last", file);
+    rewind(file);
+
+    File_Iterator iter = file_iterator_create_indexed(file, &index);
+    while (file_iterator_next_byte(&iter) != 0) {
+    }
+    assert_equal(iter.position.offset, 5004);
+    assert_equal(iter.position.line, 1);
+
+    file_iterator_sync_position(&iter);
+    assert_equal(iter.position.line, 1001);
+    assert_equal(iter.position.column, 5);
+
+    File_Iterator_Position const position = file_iterator_locate(&iter, 502);
+    assert_equal(position.line, 101);
+    assert_equal(position.column, 3);
+
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
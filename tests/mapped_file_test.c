@@ -0,0 +1,108 @@
+#include "../chimp/testing.h"
+#include "../chimp/io/Mapped_File.h"
+#include "../chimp/strings/String_Iterator.h"
+
+#include <unistd.h>
+
+TEST(test_map_regular_file) {
+    FILE* file = tmpfile();
+    assert(file != NULL);
+    fputs("hello\nworld\n", file);
+    rewind(file);
+
+    char buffer[4] = {0};
+    Mapped_File mapped = mapped_file_create(file, buffer, sizeof(buffer));
+    assert_equal(mapped.is_mapped, 1);
+
+    char* block = NULL;
+    size_t length = mapped_file_next_block(&mapped, &block);
+    assert_equal(length, 12);
+    assert_equal(strncmp(block, "hello\nworld\n", length), 0);
+
+    String_Iterator iter = string_iterator_create(block, length);
+    String_Iterator_Result result = {0};
+    for (int i = 0; i < 7; i += 1) {
+        result = string_iterator_next(&iter);
+    }
+    assert_equal(result.byte, 'w');
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 2);
+
+    assert_equal(mapped_file_next_block(&mapped, &block), 0);
+
+    mapped_file_destroy(&mapped);
+    fclose(file);
+    return 0;
+}
+
+TEST(test_map_from_current_position) {
+    FILE* file = tmpfile();
+    assert(file != NULL);
+    fputs("hello\nworld\n", file);
+    fseek(file, 6, SEEK_SET);
+
+    char buffer[4] = {0};
+    Mapped_File mapped = mapped_file_create(file, buffer, sizeof(buffer));
+    assert_equal(mapped.is_mapped, 1);
+
+    char* block = NULL;
+    size_t length = mapped_file_next_block(&mapped, &block);
+    assert_equal(length, 6);
+    assert_equal(strncmp(block, "world\n", length), 0);
+
+    mapped_file_destroy(&mapped);
+    fclose(file);
+    return 0;
+}
+
+TEST(test_map_empty_file) {
+    FILE* file = tmpfile();
+    assert(file != NULL);
+
+    char buffer[4] = {0};
+    Mapped_File mapped = mapped_file_create(file, buffer, sizeof(buffer));
+    assert_equal(mapped.is_mapped, 1);
+
+    char* block = NULL;
+    assert_equal(mapped_file_next_block(&mapped, &block), 0);
+
+    mapped_file_destroy(&mapped);
+    fclose(file);
+    return 0;
+}
+
+TEST(test_pipe_falls_back_to_buffered) {
+    int fds[2];
+    assert_equal(pipe(fds), 0);
+    assert_equal(write(fds[1], "hello\nworld\n", 12), 12);
+    close(fds[1]);
+
+    FILE* file = fdopen(fds[0], "r");
+    assert(file != NULL);
+
+    char buffer[5] = {0};
+    Mapped_File mapped = mapped_file_create(file, buffer, sizeof(buffer));
+    assert_equal(mapped.is_mapped, 0);
+
+    char contents[16] = {0};
+    size_t total = 0;
+    char* block = NULL;
+    size_t length = 0;
+
+    while ((length = mapped_file_next_block(&mapped, &block)) > 0) {
+        assert(length <= sizeof(buffer));
+        memcpy(contents + total, block, length);
+        total += length;
+    }
+
+    assert_equal(total, 12);
+    assert_equal_string(contents, "hello\nworld\n");
+
+    mapped_file_destroy(&mapped);
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,228 @@
+#include "../chimp/testing.h"
+#include "../chimp/strings/parse.h"
+#include "../chimp/strings/String_Builder.h"
+#include "../chimp/strings/String_Iterator.h"
+#include "../chimp/io/File_Reader.h"
+
+#include <locale.h>
+
+TEST(test_parse_u64) {
+    uint64_t value = 0;
+    size_t consumed = 0;
+
+    assert_equal(parse_u64("12345678901234567890,", 21, &value, &consumed), PARSE_ERROR_NONE);
+    assert_equal(value, 12345678901234567890ull);
+    assert_equal(consumed, 20);
+
+    assert_equal(parse_u64("+7", 2, &value, &consumed), PARSE_ERROR_NONE);
+    assert_equal(value, 7);
+    assert_equal(consumed, 2);
+
+    assert_equal(parse_u64("18446744073709551615", 20, &value, &consumed), PARSE_ERROR_NONE);
+    assert_equal(value, UINT64_MAX);
+
+    assert_equal(parse_u64("18446744073709551616", 20, &value, &consumed), PARSE_ERROR_RANGE);
+    assert_equal(value, UINT64_MAX);
+    assert_equal(consumed, 0);
+
+    assert_equal(parse_u64("-1", 2, &value, &consumed), PARSE_ERROR_SYNTAX);
+    assert_equal(consumed, 0);
+    assert_equal(parse_u64("+x", 2, &value, &consumed), PARSE_ERROR_SYNTAX);
+    assert_equal(consumed, 1);
+    assert_equal(parse_u64("", 0, &value, &consumed), PARSE_ERROR_SYNTAX);
+    return 0;
+}
+
+TEST(test_parse_i64) {
+    int64_t value = 0;
+    size_t consumed = 0;
+
+    assert_equal(parse_i64("-9223372036854775808 ", 21, &value, &consumed), PARSE_ERROR_NONE);
+    assert_equal(value, INT64_MIN);
+    assert_equal(consumed, 20);
+
+    assert_equal(parse_i64("9223372036854775807", 19, &value, &consumed), PARSE_ERROR_NONE);
+    assert_equal(value, INT64_MAX);
+
+    assert_equal(parse_i64("9223372036854775808", 19, &value, &consumed), PARSE_ERROR_RANGE);
+    assert_equal(value, INT64_MAX);
+    assert_equal(parse_i64("-9223372036854775809", 20, &value, &consumed), PARSE_ERROR_RANGE);
+    assert_equal(value, INT64_MIN);
+    assert_equal(consumed, 1);
+
+    assert_equal(parse_i64("-", 1, &value, &consumed), PARSE_ERROR_SYNTAX);
+    assert_equal(consumed, 1);
+
+    // Every length around the 8 digit chunks.
+    int64_t expected = 0;
+    char digits[] = "-1234567890123456789";
+    for (size_t length = 2; length < sizeof(digits); length += 1) {
+        expected = expected * 10 + (digits[length - 1] - '0');
+        assert_equal(parse_i64(digits, length, &value, &consumed), PARSE_ERROR_NONE);
+        assert_equal(value, -expected);
+        assert_equal(consumed, length);
+    }
+    return 0;
+}
+
+TEST(test_parse_f64) {
+    char const* const inputs[] = {
+        "0", "-0.0", "1.5", ".25", "3.", "1e10", "2.5E-3", "123456789012345678901234567890",
+        "0.000000000000000000000000000001", "1.7976931348623157e308", "4.9e-324", "2.2250738585072011e-308",
+        "9007199254740993", "0.1000000000000000055511151231257827", "1e-400",
+    };
+
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i += 1) {
+        double value = 0;
+        size_t consumed = 0;
+        size_t const length = strlen(inputs[i]);
+        assert_equal(parse_f64(inputs[i], length, &value, &consumed), PARSE_ERROR_NONE);
+        assert_equal(consumed, length);
+        double const expected = strtod(inputs[i], NULL);
+        assert(memcmp(&value, &expected, sizeof(value)) == 0);
+    }
+
+    double value = 0;
+    size_t consumed = 0;
+
+    // An exponent without digits is not part of the number.
+    assert_equal(parse_f64("12e+x", 5, &value, &consumed), PARSE_ERROR_NONE);
+    assert_equal(consumed, 2);
+    assert(value == 12);
+
+    assert_equal(parse_f64("-Infinity", 9, &value, &consumed), PARSE_ERROR_NONE);
+    assert(isinf(value) && value < 0);
+    assert_equal(parse_f64("NaN", 3, &value, &consumed), PARSE_ERROR_NONE);
+    assert(isnan(value));
+
+    // Just above the halfway point between 2^53 and 2^53 + 2, which the truncated digits
+    // can't tell, so strtod decides. It must get the decimal point of the current locale,
+    // which is more than one byte in e.g. ps_AF. Checked in the locales that are installed.
+    char const* const near_halfway = "9007199254740993.000000000000000000001";
+    char const* const locales[] = { "C", "de_DE.UTF-8", "fr_FR.UTF-8", "ps_AF.UTF-8" };
+    for (size_t i = 0; i < sizeof(locales) / sizeof(locales[0]); i += 1) {
+        if (setlocale(LC_NUMERIC, locales[i]) == NULL) {
+            continue;
+        }
+        assert_equal(parse_f64(near_halfway, strlen(near_halfway), &value, &consumed), PARSE_ERROR_NONE);
+        setlocale(LC_NUMERIC, "C");
+        assert(value == 9007199254740994.0);
+    }
+
+    assert_equal(parse_f64("1e309", 5, &value, &consumed), PARSE_ERROR_RANGE);
+    assert(isinf(value));
+    assert_equal(parse_f64("-.", 2, &value, &consumed), PARSE_ERROR_SYNTAX);
+    assert_equal(consumed, 1);
+    assert_equal(parse_f64("x", 1, &value, &consumed), PARSE_ERROR_SYNTAX);
+    assert_equal(consumed, 0);
+
+    // Whatever the builder writes must read back as the same double.
+    uint64_t bits = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 100000; i += 1) {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        double original = 0;
+        memcpy(&original, &bits, sizeof(original));
+        if (!isfinite(original)) {
+            continue;
+        }
+
+        char buffer[64] = {0};
+        String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+        assert_equal(string_builder_printf(&builder, i % 2 ? "%.17g" : "%.25e", original), 0);
+        assert_equal(parse_f64(builder.buffer, builder.length, &value, &consumed), PARSE_ERROR_NONE);
+        assert_equal(consumed, builder.length);
+        double const expected = strtod(builder.buffer, NULL);
+        assert(memcmp(&value, &expected, sizeof(value)) == 0);
+    }
+
+    return 0;
+}
+
+TEST(test_string_iterator_parse) {
+    char string[] = "42 -7 2.5\n12x";
+    String_Iterator iter = string_iterator_create(string, sizeof(string) - 1);
+    Byte_Class const spaces = byte_class_create(" \n");
+
+    int64_t integer = 0;
+    assert_equal(string_iterator_parse_i64(&iter, &integer), PARSE_ERROR_NONE);
+    assert_equal(integer, 42);
+    assert_equal(iter.position.column, 3);
+    string_iterator_skip_while(&iter, &spaces);
+
+    assert_equal(string_iterator_parse_i64(&iter, &integer), PARSE_ERROR_NONE);
+    assert_equal(integer, -7);
+    string_iterator_skip_while(&iter, &spaces);
+
+    double number = 0;
+    assert_equal(string_iterator_parse_f64(&iter, &number), PARSE_ERROR_NONE);
+    assert(number == 2.5);
+    string_iterator_skip_while(&iter, &spaces);
+
+    uint64_t unsigned_integer = 0;
+    assert_equal(string_iterator_parse_u64(&iter, &unsigned_integer), PARSE_ERROR_NONE);
+    assert_equal(unsigned_integer, 12);
+    assert_equal(string_iterator_parse_u64(&iter, &unsigned_integer), PARSE_ERROR_SYNTAX);
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 3);
+    return 0;
+}
+
+TEST(test_file_reader_parse) {
+    FILE* const file = tmpfile();
+    assert(file != NULL);
+    for (int i = 0; i < 1000; i += 1) {
+        fprintf(file, "%d -%d.25\n", i, i);
+    }
+    rewind(file);
+
+    char buffer[64];
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+    Byte_Class const spaces = byte_class_create(" \n");
+
+    for (int i = 0; i < 1000; i += 1) {
+        uint64_t integer = 0;
+        double number = 0;
+        assert_equal(file_reader_parse_u64(&reader, &integer), PARSE_ERROR_NONE);
+        assert_equal(integer, (uint64_t)i);
+        file_reader_skip_while(&reader, &spaces);
+        assert_equal(file_reader_parse_f64(&reader, &number), PARSE_ERROR_NONE);
+        assert(number == -(i + 0.25));
+        file_reader_skip_while(&reader, &spaces);
+    }
+
+    int64_t integer = 0;
+    assert_equal(file_reader_parse_i64(&reader, &integer), PARSE_ERROR_SYNTAX);
+    fclose(file);
+    return 0;
+}
+
+TEST(test_file_reader_parse_window) {
+    FILE* const file = tmpfile();
+    assert(file != NULL);
+    for (int i = 0; i < 100; i += 1) {
+        fputc('0', file);
+    }
+    fputs(" 7", file);
+    rewind(file);
+
+    char buffer[64];
+    File_Reader reader = file_reader_create(file, buffer, sizeof(buffer));
+    Byte_Class const spaces = byte_class_create(" ");
+
+    // The number fills the whole window, so it is cut off and the window is consumed.
+    uint64_t integer = 0;
+    assert_equal(file_reader_parse_u64(&reader, &integer), PARSE_ERROR_RANGE);
+    assert_equal(file_reader_parse_u64(&reader, &integer), PARSE_ERROR_NONE);
+    assert_equal(integer, 0);
+    file_reader_skip_while(&reader, &spaces);
+    assert_equal(file_reader_parse_u64(&reader, &integer), PARSE_ERROR_NONE);
+    assert_equal(integer, 7);
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,162 @@
+#include "../chimp/testing.h"
+#include "../chimp/mem/Pool.h"
+
+typedef struct Node Node;
+struct Node {
+    Node* next;
+    uint64_t value;
+    uint8_t tag;
+};
+
+TEST(test_alloc_until_full) {
+    uint8_t buffer[16 + 4 * sizeof(Node)];
+    Pool pool = pool_create(buffer, sizeof(buffer), sizeof(Node));
+    assert_equal(pool.object_size % sizeof(void*), 0);
+
+    size_t count = 0;
+    Node* node = NULL;
+    while ((node = pool_alloc(&pool)) != NULL) {
+        assert_equal((uintptr_t)node % sizeof(void*), 0);
+        assert_equal(node->value, 0);
+        node->value = count;
+        count += 1;
+    }
+
+    assert(count >= 3);
+    assert(count <= 4);
+    return 0;
+}
+
+TEST(test_free_reuses_objects) {
+    uint8_t buffer[1024];
+    Pool pool = pool_create(buffer, sizeof(buffer), sizeof(Node));
+
+    Node* const first = pool_alloc(&pool);
+    Node* const second = pool_alloc(&pool);
+    assert(first != NULL && second != NULL);
+    assert(first != second);
+
+    second->value = 42;
+    pool_free(&pool, second);
+    pool_free(&pool, first);
+
+    assert(pool_alloc(&pool) == first);
+    Node* const third = pool_alloc(&pool);
+    assert(third == second);
+    assert_equal(third->value, 0);
+    return 0;
+}
+
+TEST(test_poison) {
+#ifndef NDEBUG
+    uint8_t buffer[1024];
+    Pool pool = pool_create(buffer, sizeof(buffer), sizeof(Node));
+
+    Node* const node = pool_alloc(&pool);
+    assert(node != NULL);
+    assert_equal(pool_is_poisoned(&pool, node), 0);
+    assert_equal(pool_is_marked(&pool, node), 0);
+    pool_free(&pool, node);
+    assert_equal(node->tag, LIBCHIMP_POOL_POISON);
+    assert_equal(pool_is_poisoned(&pool, node), 1);
+    assert_equal(pool_is_marked(&pool, node), 1);
+    assert(pool_take(&pool) == node);
+    assert_equal(pool_is_marked(&pool, node), 0);
+#endif
+    return 0;
+}
+
+TEST(test_free_recycled) {
+    uint8_t buffer[1024];
+    Pool pool = pool_create(buffer, sizeof(buffer), sizeof(Node));
+    Pool_Cache cache = pool_cache_create(&pool, 8);
+
+    // A recycled object that is only partly written is still poisoned past the link,
+    // which must not look like a double free.
+    Node* const node = pool_take(&pool);
+    assert(node != NULL);
+    pool_free(&pool, node);
+    Node* const recycled = pool_take(&pool);
+    assert(recycled == node);
+    recycled->next = NULL;
+    pool_free(&pool, recycled);
+    assert(pool.free_list == (Pool_Node*)node);
+
+    Node* const cached = pool_cache_alloc(&cache);
+    assert(cached != NULL);
+    memset(cached, LIBCHIMP_POOL_POISON, sizeof(Node));
+    cached->next = NULL;
+    pool_cache_free(&cache, cached);
+    assert(cache.free_list == (Pool_Node*)cached);
+    return 0;
+}
+
+void* test_allocator_alloc(void* const context, size_t const size) {
+    (void)context;
+    return malloc(size);
+}
+
+void test_allocator_free(void* const context, void* const pointer, size_t const size) {
+    (void)context;
+    (void)size;
+    free(pointer);
+}
+
+TEST(test_chained) {
+    Arena_Allocator const allocator = {
+        .alloc = test_allocator_alloc,
+        .free = test_allocator_free,
+        .context = NULL,
+    };
+    Chained_Arena arena = chained_arena_create(allocator, 4096);
+    Pool pool = pool_create_chained(&arena, sizeof(Node), 16);
+
+    Node* nodes[100];
+    for (int i = 0; i < 100; i += 1) {
+        nodes[i] = pool_alloc(&pool);
+        assert(nodes[i] != NULL);
+        nodes[i]->value = i;
+    }
+    for (int i = 0; i < 100; i += 1) {
+        assert_equal(nodes[i]->value, i);
+    }
+
+    chained_arena_destroy(&arena);
+    return 0;
+}
+
+TEST(test_cache) {
+    uint8_t buffer[4096];
+    Pool pool = pool_create(buffer, sizeof(buffer), sizeof(Node));
+    Pool_Cache cache = pool_cache_create(&pool, 8);
+
+    Node* nodes[20];
+    for (int i = 0; i < 20; i += 1) {
+        nodes[i] = pool_cache_alloc(&cache);
+        assert(nodes[i] != NULL);
+        assert_equal(nodes[i]->value, 0);
+        nodes[i]->value = i;
+    }
+    assert(cache.count < 8);
+
+    for (int i = 0; i < 20; i += 1) {
+        pool_cache_free(&cache, nodes[i]);
+        assert(cache.count <= 8);
+    }
+    assert(pool.free_list != NULL);
+
+    pool_cache_flush(&cache);
+    assert_equal(cache.count, 0);
+    assert(cache.free_list == NULL);
+
+    size_t count = 0;
+    for (Pool_Node* node = pool.free_list; node != NULL; node = node->next) {
+        count += 1;
+    }
+    assert(count >= 20);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
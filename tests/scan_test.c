@@ -0,0 +1,161 @@
+#include "../chimp/testing.h"
+#include "../chimp/scan.h"
+
+#include <stdlib.h>
+
+// Fill the buffer with mostly letters and the occasional newline.
+void fill_random(char* const buffer, size_t const length, unsigned const seed) {
+    srand(seed);
+    for (size_t i = 0; i < length; i += 1) {
+        buffer[i] = rand() % 13 == 0 ? '\n' : (char)('a' + rand() % 26);
+    }
+}
+
+TEST(test_find_byte) {
+    char buffer[1000];
+    fill_random(buffer, sizeof(buffer), 1);
+
+    for (size_t offset = 0; offset < 40; offset += 1) {
+        for (size_t length = 0; offset + length <= sizeof(buffer); length += 37) {
+            char const* const data = buffer + offset;
+            size_t const expected = scan_find_byte_scalar(data, length, '\n');
+            assert_equal(scan_find_byte(data, length, '\n'), expected);
+            assert_equal(scan_find_byte(data, length, 0), length);
+#ifdef LIBCHIMP_SCAN_X86
+            assert_equal(scan_find_byte_sse2(data, length, '\n'), expected);
+            if (scan_has_avx2()) {
+                assert_equal(scan_find_byte_avx2(data, length, '\n'), expected);
+            }
+#endif
+        }
+    }
+
+    return 0;
+}
+
+TEST(test_count_byte) {
+    static char buffer[20000];
+    fill_random(buffer, sizeof(buffer), 2);
+
+    for (size_t offset = 0; offset < 40; offset += 1) {
+        for (size_t length = 0; offset + length <= sizeof(buffer); length += 997) {
+            char const* const data = buffer + offset;
+            size_t const expected = scan_count_byte_scalar(data, length, '\n');
+            assert_equal(scan_count_byte(data, length, '\n'), expected);
+#ifdef LIBCHIMP_SCAN_X86
+            assert_equal(scan_count_byte_sse2(data, length, '\n'), expected);
+            if (scan_has_avx2()) {
+                assert_equal(scan_count_byte_avx2(data, length, '\n'), expected);
+            }
+#endif
+        }
+    }
+
+    return 0;
+}
+
+TEST(test_find_last_byte) {
+    assert_equal(scan_find_last_byte("a\nb\nc", 5, '\n'), 3);
+    assert_equal(scan_find_last_byte("abc", 3, '\n'), 3);
+    assert_equal(scan_find_last_byte("", 0, '\n'), 0);
+    return 0;
+}
+
+TEST(test_byte_class) {
+    Byte_Class const whitespace = byte_class_create(" \t\n");
+    assert_equal(byte_class_contains(&whitespace, ' '), 1);
+    assert_equal(byte_class_contains(&whitespace, '\t'), 1);
+    assert_equal(byte_class_contains(&whitespace, 'a'), 0);
+    assert_equal(byte_class_contains(&whitespace, (char)0xFF), 0);
+    assert_equal(scan_skip_class(" \t\n x", 5, &whitespace), 4);
+    assert_equal(scan_skip_class("   ", 3, &whitespace), 3);
+    return 0;
+}
+
+TEST(test_find_any) {
+    char buffer[1000];
+    fill_random(buffer, sizeof(buffer), 3);
+    char const bytes[] = { 'x', 'y', '\n' };
+
+    for (size_t offset = 0; offset < 40; offset += 1) {
+        for (size_t length = 0; offset + length <= sizeof(buffer); length += 37) {
+            char const* const data = buffer + offset;
+            size_t const expected = scan_find_any_scalar(data, length, bytes, sizeof(bytes));
+            assert_equal(scan_find_any(data, length, bytes, sizeof(bytes)), expected);
+            assert_equal(scan_find_any(data, length, "#", 1), length);
+#ifdef LIBCHIMP_SCAN_X86
+            assert_equal(scan_find_any_sse2(data, length, bytes, sizeof(bytes)), expected);
+            if (scan_has_avx2()) {
+                assert_equal(scan_find_any_avx2(data, length, bytes, sizeof(bytes)), expected);
+            }
+#endif
+        }
+    }
+
+    return 0;
+}
+
+TEST(test_find_json_escape) {
+    char buffer[1000];
+    fill_random(buffer, sizeof(buffer), 4);
+    for (size_t i = 0; i < sizeof(buffer); i += 1) {
+        if (buffer[i] == '\n') {
+            buffer[i] = 'a';
+        }
+    }
+    buffer[300] = '"';
+    buffer[500] = '\\';
+    buffer[700] = 0x1F;
+    buffer[800] = (char)0xC3;
+    buffer[900] = 0x7F;
+
+    assert_equal(scan_is_json_escape((char)0xC3), 0);
+    assert_equal(scan_is_json_escape(0x7F), 0);
+    assert_equal(scan_is_json_escape(0), 1);
+
+    for (size_t offset = 0; offset < 1000; offset += 7) {
+        char const* const data = buffer + offset;
+        size_t const length = sizeof(buffer) - offset;
+        size_t const expected = scan_find_json_escape_scalar(data, length);
+        assert_equal(scan_find_json_escape(data, length), expected);
+#ifdef LIBCHIMP_SCAN_X86
+        assert_equal(scan_find_json_escape_sse2(data, length), expected);
+        if (scan_has_avx2()) {
+            assert_equal(scan_find_json_escape_avx2(data, length), expected);
+        }
+#endif
+    }
+
+    return 0;
+}
+
+TEST(test_find_substring) {
+    char buffer[1000];
+    fill_random(buffer, sizeof(buffer), 5);
+    char const* const needles[] = { "ab", "xyz", "\nq", "needle that is rather long", "" };
+    memcpy(buffer + 950, "needle that is rather long", 26);
+
+    for (size_t n = 0; n < sizeof(needles) / sizeof(needles[0]); n += 1) {
+        char const* const needle = needles[n];
+        size_t const needle_length = strlen(needle);
+        for (size_t offset = 0; offset < 40; offset += 1) {
+            for (size_t length = 0; offset + length <= sizeof(buffer); length += 37) {
+                char const* const data = buffer + offset;
+                size_t const expected = scan_find_substring_scalar(data, length, needle, needle_length);
+                assert_equal(scan_find_substring(data, length, needle, needle_length), expected);
+#ifdef LIBCHIMP_SCAN_X86
+                assert_equal(scan_find_substring_sse2(data, length, needle, needle_length), expected);
+                if (scan_has_avx2()) {
+                    assert_equal(scan_find_substring_avx2(data, length, needle, needle_length), expected);
+                }
+#endif
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,86 @@
+#include "../chimp/testing.h"
+#include "../chimp/strings/Str.h"
+#include "../chimp/strings/String_Builder.h"
+#include "../chimp/strings/String_Iterator.h"
+
+TEST(test_find) {
+    Str const str = STR_LITERAL("the quick brown fox jumps over the lazy dog, the end");
+    assert_equal(str.length, 52);
+    assert_equal(str_find_byte(str, 'q'), 4);
+    assert_equal(str_find_byte(str, '#'), str.length);
+    assert_equal(str_find_any(str, STR_LITERAL("zx")), 18);
+    assert_equal(str_find(str, STR_LITERAL("the")), 0);
+    assert_equal(str_find(str, STR_LITERAL("lazy dog")), 35);
+    assert_equal(str_find(str, STR_LITERAL("the end")), 45);
+    assert_equal(str_find(str, STR_LITERAL("the cat")), str.length);
+    assert_equal(str_find(str, STR_LITERAL("")), 0);
+    assert_equal(str_contains(str, STR_LITERAL("fox")), 1);
+    assert_equal(str_contains(STR_LITERAL("ab"), STR_LITERAL("abc")), 0);
+    return 0;
+}
+
+TEST(test_compare) {
+    Str const abc = STR_LITERAL("abc");
+    assert_equal(str_equal(abc, str_from_cstring("abc")), 1);
+    assert_equal(str_equal(abc, STR_LITERAL("abd")), 0);
+    assert(str_compare(abc, STR_LITERAL("abd")) < 0);
+    assert(str_compare(abc, STR_LITERAL("ab")) > 0);
+    assert_equal(str_compare(abc, abc), 0);
+    assert_equal(str_compare(STR_LITERAL(""), str_create(NULL, 0)), 0);
+    assert_equal(str_starts_with(abc, STR_LITERAL("ab")), 1);
+    assert_equal(str_starts_with(abc, STR_LITERAL("abcd")), 0);
+    assert_equal(str_ends_with(abc, STR_LITERAL("bc")), 1);
+    assert_equal(str_ends_with(abc, STR_LITERAL("b")), 0);
+    return 0;
+}
+
+TEST(test_trim) {
+    assert(str_equal(str_trim(STR_LITERAL(" \t value \r\n")), STR_LITERAL("value")));
+    assert(str_equal(str_trim_left(STR_LITERAL("  a ")), STR_LITERAL("a ")));
+    assert(str_equal(str_trim_right(STR_LITERAL("  a ")), STR_LITERAL("  a")));
+    assert_equal(str_trim(STR_LITERAL("   ")).length, 0);
+    return 0;
+}
+
+TEST(test_split) {
+    Str_Split split = str_split(STR_LITERAL("a,,bc,"), ',');
+    Str const expected[] = { STR_LITERAL("a"), STR_LITERAL(""), STR_LITERAL("bc"), STR_LITERAL("") };
+    Str part;
+    size_t count = 0;
+    while (str_split_next(&split, &part)) {
+        assert(count < 4);
+        assert(str_equal(part, expected[count]));
+        count += 1;
+    }
+    assert_equal(count, 4);
+
+    Str key;
+    Str value;
+    assert_equal(str_split_once(STR_LITERAL("key=value=1"), '=', &key, &value), 1);
+    assert(str_equal(key, STR_LITERAL("key")));
+    assert(str_equal(value, STR_LITERAL("value=1")));
+    assert_equal(str_split_once(STR_LITERAL("novalue"), '=', &key, &value), 0);
+    return 0;
+}
+
+TEST(test_interop) {
+    char text[] = "name: chimp\nsize: 3\n";
+    String_Iterator iter = string_iterator_create(text, sizeof(text) - 1);
+    String_Iterator_Slice const line = string_iterator_next_line(&iter);
+    assert(str_equal(string_iterator_slice_str(line), STR_LITERAL("name: chimp")));
+    assert(str_equal(string_iterator_rest(&iter), STR_LITERAL("size: 3\n")));
+
+    char buffer[64] = {0};
+    String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+    Str const name = str_trim(str_slice(string_iterator_slice_str(line), 5, line.length));
+    assert_equal(string_builder_write_byte(&builder, '['), 0);
+    assert_equal(string_builder_write_str(&builder, name), 0);
+    assert_equal(string_builder_write_byte(&builder, ']'), 0);
+    assert_equal(string_builder_write_str(&builder, STR_LITERAL("!")), 0);
+    assert(str_equal(string_builder_to_str(&builder), STR_LITERAL("[chimp]!")));
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
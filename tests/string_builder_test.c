@@ -1,7 +1,7 @@
 #include "../chimp/testing.h"
 #include "../chimp/strings/String_Builder.h"
 
-int test_create(void) {
+TEST(test_create) {
     char buffer[3] = {0};
     String_Builder builder = string_builder_create(buffer, 3);
     assert_equal(builder.buffer, buffer);
@@ -10,7 +10,7 @@ int test_create(void) {
     return 0;
 }
 
-int test_write_byte(void) {
+TEST(test_write_byte) {
     char buffer[3] = {0};
     String_Builder builder = string_builder_create(buffer, sizeof(buffer));
     assert_equal(string_builder_write_byte(&builder, 'A'), 0);
@@ -20,7 +20,7 @@ int test_write_byte(void) {
     return 0;
 }
 
-int test_write_bytes(void) {
+TEST(test_write_bytes) {
     char buffer[4] = {0};
     String_Builder builder = string_builder_create(buffer, sizeof(buffer));
     assert_equal(string_builder_write_bytes(&builder, "AB", 2), 0);
@@ -29,7 +29,7 @@ int test_write_bytes(void) {
     return 0;
 }
 
-int test_write_string(void) {
+TEST(test_write_string) {
     char buffer[4] = {0};
     String_Builder builder = string_builder_create(buffer, sizeof(buffer));
     assert_equal(string_builder_write_string(&builder, "AB"), 0);
@@ -38,17 +38,278 @@ int test_write_string(void) {
     return 0;
 }
 
-int main(void) {
-    int failures = (
-        + test_create()
-        + test_write_byte()
-        + test_write_bytes()
-        + test_write_string()
-    );
-    fprintf(
-        stderr,
-        __FILE__ " %sFailed tests: %d\n\033[0m",
-        failures ? "\033[31m" : "\033[32m", failures
+TEST(test_write_int) {
+    char buffer[64] = {0};
+    String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+    assert_equal(string_builder_write_int(&builder, 0), 0);
+    assert_equal(string_builder_write_byte(&builder, ' '), 0);
+    assert_equal(string_builder_write_int(&builder, -7), 0);
+    assert_equal(string_builder_write_byte(&builder, ' '), 0);
+    assert_equal(string_builder_write_int(&builder, 1234567), 0);
+    assert_equal(string_builder_write_byte(&builder, ' '), 0);
+    assert_equal(string_builder_write_int(&builder, INT64_MIN), 0);
+    assert_equal_string(builder.buffer, "0 -7 1234567 -9223372036854775808");
+
+    char small[4] = {0};
+    String_Builder small_builder = string_builder_create(small, sizeof(small));
+    assert_equal(string_builder_write_int(&small_builder, -100), 1);
+    assert_equal(small_builder.length, 0);
+    assert_equal(string_builder_write_int(&small_builder, -10), 0);
+    assert_equal_string(small_builder.buffer, "-10");
+    return 0;
+}
+
+TEST(test_write_uint) {
+    char buffer[64] = {0};
+    String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+    uint64_t power = 1;
+    for (int i = 0; i < 20; i += 1) {
+        char expected[32] = {0};
+        builder.length = 0;
+        memset(buffer, 0, sizeof(buffer));
+        assert_equal(string_builder_write_uint(&builder, power - 1), 0);
+        snprintf(expected, sizeof(expected), "%llu", (unsigned long long)(power - 1));
+        assert_equal_string(builder.buffer, expected);
+        power *= 10;
+    }
+
+    builder.length = 0;
+    memset(buffer, 0, sizeof(buffer));
+    assert_equal(string_builder_write_uint(&builder, UINT64_MAX), 0);
+    assert_equal_string(builder.buffer, "18446744073709551615");
+    return 0;
+}
+
+TEST(test_printf_float) {
+    char buffer[128] = {0};
+    String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+    assert_equal(string_builder_printf(&builder, "%f|%.2f|%.0f|%.0f|", 1.5, -0.125, 0.5, 2.5), 0);
+    assert_equal(string_builder_printf(&builder, "%e|%.3e|%g|%g|%.3g", 12345.678, 9.9996, 0.0001, 1e-5, 1234.5), 0);
+    assert_equal_string(
+        builder.buffer,
+        "1.500000|-0.12|0|2|1.234568e+04|1.000e+01|0.0001|1e-05|1.23e+03"
     );
+
+    builder.length = 0;
+    memset(buffer, 0, sizeof(buffer));
+    assert_equal(string_builder_printf(&builder, "%f %e %g", 1.0 / 0.0, -1.0 / 0.0, 0.0 / 0.0), 0);
+    assert_equal_string(builder.buffer, "inf -inf nan");
+    return 0;
+}
+
+TEST(test_write_f64) {
+    double const values[] = {
+        0.1, -2.5, 1e21, 1e-7, 123456.789, 5e-324, 1.7976931348623157e308,
+        2.7183163742986588e276, -66766885433589619.0,
+    };
+    char const* const expected[] = {
+        "0.1", "-2.5", "1e+21", "1e-7", "123456.789", "5e-324", "1.7976931348623157e+308",
+        "2.718316374298659e+276", "-66766885433589620",
+    };
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i += 1) {
+        char buffer[64] = {0};
+        String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+        assert_equal(string_builder_write_f64(&builder, values[i]), 0);
+        assert_equal_string(builder.buffer, expected[i]);
+    }
+
+    // Every output must read back as the same double, and one digit less must not.
+    uint64_t bits = 0x123456789ABCDEFull;
+    for (int i = 0; i < 10000; i += 1) {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        double value = 0;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) {
+            continue;
+        }
+
+        char buffer[64] = {0};
+        String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+        assert_equal(string_builder_write_f64(&builder, value), 0);
+        double const parsed = strtod(builder.buffer, NULL);
+        assert(memcmp(&parsed, &value, sizeof(value)) == 0);
+
+        // The significant digits go from the first nonzero one to the last one before the exponent.
+        int first = -1;
+        int last = -1;
+        int position = 0;
+        for (size_t j = 0; j < builder.length && builder.buffer[j] != 'e'; j += 1) {
+            char const ch = builder.buffer[j];
+            if (ch >= '0' && ch <= '9') {
+                if (ch != '0') {
+                    first = first < 0 ? position : first;
+                    last = position;
+                }
+                position += 1;
+            }
+        }
+        int const digits = last - first + 1;
+        if (digits > 1) {
+            char shorter[64] = {0};
+            snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, value);
+            double const reparsed = strtod(shorter, NULL);
+            assert(memcmp(&reparsed, &value, sizeof(value)) != 0);
+        }
+    }
+
     return 0;
 }
+
+TEST(test_write_f32) {
+    float const values[] = { 0.1f, 1.0f / 3.0f, -2.5f, 16777216.0f, 1e-45f, 3.4028235e38f, -0.0f };
+    char const* const expected[] = { "0.1", "0.33333334", "-2.5", "16777216", "1e-45", "3.4028235e+38", "-0" };
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i += 1) {
+        char buffer[64] = {0};
+        String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+        assert_equal(string_builder_write_f32(&builder, values[i]), 0);
+        assert_equal_string(builder.buffer, expected[i]);
+    }
+
+    // Every output must read back as the same float.
+    uint32_t bits = 0x12345678u;
+    for (int i = 0; i < 10000; i += 1) {
+        bits ^= bits << 13;
+        bits ^= bits >> 17;
+        bits ^= bits << 5;
+        float value = 0;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) {
+            continue;
+        }
+
+        char buffer[64] = {0};
+        String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+        assert_equal(string_builder_write_f32(&builder, value), 0);
+        float const parsed = strtof(builder.buffer, NULL);
+        assert(memcmp(&parsed, &value, sizeof(value)) == 0);
+    }
+
+    return 0;
+}
+
+TEST(test_printf_integers) {
+    char buffer[128] = {0};
+    String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+    int const small = -42;
+    long const medium = -1234567890L;
+    long long const large = INT64_MIN;
+    size_t const size = SIZE_MAX;
+    assert_equal(string_builder_printf(&builder, "%d %u %ld %lld %zu %c%s 100%%", small, 7u, medium, large, size, 'x', "y"), 0);
+    assert_equal_string(builder.buffer, "-42 7 -1234567890 -9223372036854775808 18446744073709551615 xy 100%");
+    return 0;
+}
+
+TEST(test_print) {
+#if __STDC_VERSION__ >= 201112L
+    char buffer[128] = {0};
+    String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+    char const* const name = "chimp";
+    int const count = -3;
+    size_t const size = 42;
+    unsigned char const byte = 255;
+    assert_equal(string_builder_print(&builder, "name=", name, " count=", count, " size=", size, " byte=", byte), 0);
+    // Character literals are ints in C, only char variables are written as characters.
+    char const letter = 'z';
+    assert_equal(string_builder_print(&builder, " ratio=", 0.25, " ok=", (_Bool)1, " ", letter, ' ', " f=", 0.1f), 0);
+    assert_equal_string(builder.buffer, "name=chimp count=-3 size=42 byte=255 ratio=0.25 ok=true z32 f=0.1");
+
+    char small[8] = {0};
+    String_Builder small_builder = string_builder_create(small, sizeof(small));
+    assert_equal(string_builder_print(&small_builder, "abc", 1234, "never written"), 1);
+    assert_equal_string(small_builder.buffer, "abc1234");
+#endif
+    return 0;
+}
+
+TEST(test_arena_growth) {
+    uint8_t memory[1024];
+    Arena arena = arena_create(memory, sizeof(memory));
+    String_Builder builder;
+    assert_equal(string_builder_create_arena(&builder, &arena, 4), 0);
+
+    // The builder is the last allocation, so it grows in place.
+    char* const first_buffer = builder.buffer;
+    assert_equal(string_builder_write_string(&builder, "hello, "), 0);
+    assert_equal(string_builder_write_string(&builder, "arena "), 0);
+    assert_equal(string_builder_write_int(&builder, 42), 0);
+    assert(builder.buffer == first_buffer);
+    assert_equal_string(builder.buffer, "hello, arena 42");
+
+    // Another allocation after the buffer forces a move.
+    assert(arena_alloc(&arena, 16) != NULL);
+    assert_equal(string_builder_write_bytes(&builder, "!!!!!!!!!!!!!!!!!!!!", 20), 0);
+    assert(builder.buffer != first_buffer);
+    assert_equal_string(builder.buffer, "hello, arena 42!!!!!!!!!!!!!!!!!!!!");
+
+    // Running out of arena is an error, like a full fixed buffer.
+    char big[2048];
+    memset(big, 'x', sizeof(big));
+    assert_equal(string_builder_write_bytes(&builder, big, sizeof(big)), 1);
+    return 0;
+}
+
+TEST(test_stream) {
+    FILE* const file = tmpfile();
+    assert(file != NULL);
+    fputs("before ", file);
+
+    char buffer[16];
+    String_Builder builder = string_builder_create_file(buffer, sizeof(buffer), file);
+    for (int i = 0; i < 100; i += 1) {
+        assert_equal(string_builder_write_string(&builder, "line "), 0);
+        assert_equal(string_builder_write_int(&builder, i), 0);
+        assert_equal(string_builder_write_byte(&builder, '\n'), 0);
+    }
+    assert_equal(string_builder_write_string(&builder, "a string longer than the whole buffer\n"), 0);
+    assert_equal(string_builder_printf(&builder, "%.3f", 2.5), 0);
+    assert(builder.length < sizeof(buffer));
+    assert_equal(string_builder_flush(&builder), 0);
+    assert_equal(builder.length, 0);
+
+    char contents[1024] = {0};
+    rewind(file);
+    size_t const n = fread(contents, 1, sizeof(contents) - 1, file);
+    fclose(file);
+
+    assert(n > 0);
+    assert(strncmp(contents, "before line 0\nline 1\n", 21) == 0);
+    assert(strstr(contents, "line 99\na string longer than the whole buffer\n2.500") != NULL);
+    assert_equal(n, strlen(contents));
+    return 0;
+}
+
+TEST(test_escaping) {
+    char buffer[256] = {0};
+    String_Builder builder = string_builder_create(buffer, sizeof(buffer));
+
+    char const json[] = "say \"hi\"\\\n\t\x01 caf\xC3\xA9 and a long clean run of text";
+    assert_equal(string_builder_write_json_string(&builder, json, sizeof(json) - 1), 0);
+    assert_equal_string(builder.buffer, "\"say \\\"hi\\\"\\\\\\n\\t\\u0001 caf\xC3\xA9 and a long clean run of text\"");
+
+    builder.length = 0;
+    memset(buffer, 0, sizeof(buffer));
+    assert_equal(string_builder_write_csv_field(&builder, "plain", 5, ','), 0);
+    assert_equal(string_builder_write_byte(&builder, ','), 0);
+    assert_equal(string_builder_write_csv_field(&builder, "a,b", 3, ','), 0);
+    assert_equal(string_builder_write_byte(&builder, ','), 0);
+    assert_equal(string_builder_write_csv_field(&builder, "say \"hi\"", 8, ','), 0);
+    assert_equal(string_builder_write_byte(&builder, ','), 0);
+    assert_equal(string_builder_write_csv_field(&builder, "a;b", 3, ';'), 0);
+    assert_equal_string(builder.buffer, "plain,\"a,b\",\"say \"\"hi\"\"\",\"a;b\"");
+
+    builder.length = 0;
+    memset(buffer, 0, sizeof(buffer));
+    assert_equal(string_builder_write_shell_arg(&builder, "it's here", 9), 0);
+    assert_equal(string_builder_write_byte(&builder, ' '), 0);
+    assert_equal(string_builder_write_shell_arg(&builder, "", 0), 0);
+    assert_equal_string(builder.buffer, "'it'\\''s here' ''");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,129 @@
+#include "../chimp/testing.h"
+#include "../chimp/strings/String_Iterator.h"
+
+TEST(test_next) {
+    char string[] = "a\nb";
+    String_Iterator iter = string_iterator_create(string, 3);
+
+    String_Iterator_Result result = string_iterator_next(&iter);
+    assert_equal(result.byte, 'a');
+    assert_equal(result.position.line, 1);
+    assert_equal(result.position.column, 1);
+
+    result = string_iterator_next(&iter);
+    assert_equal(result.byte, '\n');
+
+    result = string_iterator_next(&iter);
+    assert_equal(result.byte, 'b');
+    assert_equal(result.position.line, 2);
+    assert_equal(result.position.column, 1);
+
+    result = string_iterator_next(&iter);
+    assert_equal(result.byte, 0);
+    return 0;
+}
+
+TEST(test_read_until) {
+    char string[] = "key=value\nnext=1";
+    String_Iterator iter = string_iterator_create(string, strlen(string));
+
+    String_Iterator_Slice slice = string_iterator_read_until(&iter, '=');
+    assert_equal(slice.length, 3);
+    assert_equal(strncmp(slice.string, "key", 3), 0);
+    assert_equal(string_iterator_peek(&iter).byte, '=');
+    assert_equal(iter.position.column, 4);
+
+    (void)string_iterator_next(&iter).byte;
+    slice = string_iterator_read_until(&iter, '=');
+    assert_equal(slice.length, 10);
+    assert_equal(slice.position.column, 5);
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 5);
+    assert_equal(iter.position.offset, 14);
+
+    slice = string_iterator_read_until(&iter, ';');
+    assert_equal(slice.length, 2);
+    assert_equal(iter.offset, iter.length);
+    return 0;
+}
+
+TEST(test_next_line) {
+    char string[] = "first\n\nthird";
+    String_Iterator iter = string_iterator_create(string, strlen(string));
+
+    String_Iterator_Slice slice = string_iterator_next_line(&iter);
+    assert_equal(slice.length, 5);
+    assert_equal(slice.position.line, 1);
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 1);
+
+    slice = string_iterator_next_line(&iter);
+    assert_equal(slice.length, 0);
+    assert_equal(slice.position.line, 2);
+
+    slice = string_iterator_next_line(&iter);
+    assert_equal(slice.length, 5);
+    assert_equal(slice.position.line, 3);
+    assert_equal(strncmp(slice.string, "third", 5), 0);
+    assert_equal(iter.position.column, 6);
+    assert_equal(iter.offset, iter.length);
+    return 0;
+}
+
+TEST(test_skip_while) {
+    char string[] = "  \n\t x";
+    String_Iterator iter = string_iterator_create(string, strlen(string));
+    Byte_Class const whitespace = byte_class_create(" \t\n");
+
+    assert_equal(string_iterator_skip_while(&iter, &whitespace), 5);
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 3);
+    assert_equal(string_iterator_peek(&iter).byte, 'x');
+    assert_equal(string_iterator_skip_while(&iter, &whitespace), 0);
+    return 0;
+}
+
+TEST(test_utf8) {
+    char string[] = "h\xC3\xA9llo \xE2\x82\xAC\xFF!\n\xF0\x9F\x90\x92=1";
+    String_Iterator iter = string_iterator_create_utf8(string, strlen(string));
+
+    String_Iterator_Code_Point result = string_iterator_next_code_point(&iter);
+    assert_equal(result.code_point, 'h');
+    result = string_iterator_next_code_point(&iter);
+    assert_equal(result.code_point, 0xE9);
+    assert_equal(result.position.column, 2);
+    assert_equal(iter.position.column, 3);
+    assert_equal(iter.position.offset, 3);
+
+    // Columns count code points in bulk too.
+    String_Iterator_Slice const slice = string_iterator_read_until(&iter, '\xFF');
+    assert_equal(slice.length, 7);
+    assert_equal(iter.position.column, 8);
+
+    result = string_iterator_next_code_point(&iter);
+    assert_equal(result.code_point, -1);
+    assert_equal(result.position.column, 8);
+    assert_equal(iter.position.column, 9);
+
+    (void)string_iterator_next_line(&iter).length;
+    result = string_iterator_next_code_point(&iter);
+    assert_equal(result.code_point, 0x1F412);
+    assert_equal(iter.position.line, 2);
+    assert_equal(iter.position.column, 2);
+
+    // Byte reads only count the first byte of a sequence as a column.
+    String_Iterator again = string_iterator_create_utf8(string, strlen(string));
+    for (int i = 0; i < 7; i += 1) {
+        (void)string_iterator_next(&again).byte;
+    }
+    assert_equal(again.position.column, 7);
+
+    String_Iterator bytes = string_iterator_create(string, strlen(string));
+    string_iterator_advance(&bytes, 7);
+    assert_equal(bytes.position.column, 8);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
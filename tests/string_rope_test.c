@@ -0,0 +1,71 @@
+#include "../chimp/testing.h"
+#include "../chimp/strings/String_Rope.h"
+
+#include <stdio.h>
+
+TEST(test_segments) {
+    uint8_t memory[4096];
+    Arena arena = arena_create(memory, sizeof(memory));
+    String_Rope rope;
+    assert_equal(string_rope_create(&rope, &arena, 16), 0);
+
+    char const body[] = "<outside body>";
+    assert_equal(string_builder_write_string(&rope.builder, "header: "), 0);
+    assert_equal(string_builder_write_string(&rope.builder, "count="), 0);
+    assert_equal(string_builder_write_int(&rope.builder, 12345), 0);
+    assert_equal(string_builder_write_byte(&rope.builder, ';'), 0);
+    assert_equal(string_rope_write_segment(&rope, body, sizeof(body) - 1), 0);
+    assert_equal(string_builder_write_string(&rope.builder, " and a tail that spans several chunks"), 0);
+
+    char const expected[] = "header: count=12345;<outside body> and a tail that spans several chunks";
+    assert_equal(string_rope_length(&rope), sizeof(expected) - 1);
+
+    // The outside body must be referenced, not copied.
+    int found = 0;
+    for (String_Rope_Segment const* segment = rope.head; segment != NULL; segment = segment->next) {
+        found |= segment->data == body;
+    }
+    assert(found);
+
+    FILE* const file = tmpfile();
+    assert(file != NULL);
+    assert_equal(string_rope_writev(&rope, fileno(file)), 0);
+    assert(rope.segment_count > 3);
+
+    char buffer[128] = {0};
+    rewind(file);
+    size_t const n = fread(buffer, 1, sizeof(buffer), file);
+    assert_equal(n, sizeof(expected) - 1);
+    assert_equal_string(buffer, expected);
+    fclose(file);
+    return 0;
+}
+
+TEST(test_many_segments) {
+    static uint8_t memory[64 * 1024];
+    Arena arena = arena_create(memory, sizeof(memory));
+    String_Rope rope;
+    assert_equal(string_rope_create(&rope, &arena, 64), 0);
+
+    // More segments than a single writev call takes.
+    for (int i = 0; i < 3 * LIBCHIMP_STRING_ROPE_IOV_COUNT; i += 1) {
+        assert_equal(string_rope_write_segment(&rope, "ab", 2), 0);
+        assert_equal(string_builder_write_byte(&rope.builder, 'c'), 0);
+    }
+
+    FILE* const file = tmpfile();
+    assert(file != NULL);
+    assert_equal(string_rope_writev(&rope, fileno(file)), 0);
+    assert_equal(ftell(file), 3 * 3 * LIBCHIMP_STRING_ROPE_IOV_COUNT);
+
+    char buffer[16] = {0};
+    rewind(file);
+    assert_equal(fread(buffer, 1, 9, file), 9);
+    assert_equal_string(buffer, "abcabcabc");
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
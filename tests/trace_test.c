@@ -0,0 +1,93 @@
+// A tiny ring makes the tests overwrite old events.
+#define LIBCHIMP_TRACE_EVENTS 8
+
+#include "../chimp/testing.h"
+#include "../chimp/trace.h"
+
+#include <pthread.h>
+
+Trace_Buffer main_buffer;
+Trace_Buffer worker_buffer;
+char output[8192];
+
+void traced_function(int const depth) {
+    TRACE_ZONE("traced_function");
+    if (depth > 0) {
+        traced_function(depth - 1);
+    }
+}
+
+void* worker_run(void* const argument) {
+    (void)argument;
+    trace_thread_begin(&worker_buffer, "worker \"1\"");
+    TRACE_BEGIN("work");
+    TRACE_COUNTER("items", 42);
+    TRACE_END("work");
+    trace_thread_end();
+    return NULL;
+}
+
+// Every test runs in its own process, so the export is checked with the events that
+// test_zones recorded.
+int check_write_json(void) {
+    String_Builder builder = string_builder_create(output, sizeof(output));
+    assert_equal(trace_write_json(&builder), 0);
+
+    assert(strstr(output, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}") != NULL);
+    assert(strstr(output, "\"args\":{\"name\":\"worker \\\"1\\\"\"}}") != NULL);
+    assert(strstr(output, "{\"name\":\"traced_function\",\"ph\":\"B\",\"pid\":1,\"tid\":1,\"ts\":") != NULL);
+    assert(strstr(output, "\"ph\":\"C\",\"pid\":1,\"tid\":2,\"ts\":") != NULL);
+    assert(strstr(output, ",\"args\":{\"value\":42}}") != NULL);
+    assert(strncmp(output + builder.length - 4, "\n]}\n", 4) == 0);
+
+    // Overwrite the ring so that the oldest zone loses its beginning.
+    TRACE_BEGIN("outer");
+    for (int i = 0; i < 4; i += 1) {
+        TRACE_BEGIN("inner");
+        TRACE_END("inner");
+    }
+    TRACE_END("outer");
+    assert_equal(atomic_load(&main_buffer.head), 14);
+
+    builder.length = 0;
+    memset(output, 0, sizeof(output));
+    assert_equal(trace_write_json(&builder), 0);
+    assert(strstr(output, "\"outer\"") == NULL);
+    assert(strstr(output, "\"traced_function\"") == NULL);
+
+    // The last 8 events hold 3 complete inner zones, the unmatched ends around them are left out.
+    size_t main_events = 0;
+    for (char const* found = strstr(output, "\"tid\":1,\"ts\""); found != NULL; found = strstr(found + 1, "\"tid\":1,\"ts\"")) {
+        main_events += 1;
+    }
+    assert_equal(main_events, 6);
+
+    // Too small a builder is an error.
+    char small[64];
+    String_Builder small_builder = string_builder_create(small, sizeof(small));
+    assert_equal(trace_write_json(&small_builder), 1);
+    return 0;
+}
+
+TEST(test_zones) {
+    trace_thread_begin(&main_buffer, "main");
+
+    traced_function(1);
+    assert_equal(atomic_load(&main_buffer.head), 4);
+    assert_equal(main_buffer.events[0].type, TRACE_EVENT_BEGIN);
+    assert_equal(main_buffer.events[2].type, TRACE_EVENT_END);
+    assert(main_buffer.events[3].ticks >= main_buffer.events[0].ticks);
+    assert_equal_string(main_buffer.events[3].name, "traced_function");
+
+    // Threads without a buffer record nothing.
+    pthread_t thread;
+    assert_equal(pthread_create(&thread, NULL, worker_run, NULL), 0);
+    assert_equal(pthread_join(thread, NULL), 0);
+    assert_equal(atomic_load(&worker_buffer.head), 3);
+    assert_equal(atomic_load(&main_buffer.head), 4);
+    return check_write_json();
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,80 @@
+#include "../chimp/testing.h"
+#include "../chimp/strings/utf8.h"
+
+TEST(test_decode) {
+    uint32_t code_point = 0;
+    assert_equal(utf8_decode("A", 1, &code_point), 1);
+    assert_equal(code_point, 'A');
+    assert_equal(utf8_decode("\xC3\xA9", 2, &code_point), 2);
+    assert_equal(code_point, 0xE9);
+    assert_equal(utf8_decode("\xE2\x82\xAC", 3, &code_point), 3);
+    assert_equal(code_point, 0x20AC);
+    assert_equal(utf8_decode("\xF0\x9F\x90\x92", 4, &code_point), 4);
+    assert_equal(code_point, 0x1F412);
+    assert_equal(utf8_decode("\xF4\x8F\xBF\xBF", 4, &code_point), 4);
+    assert_equal(code_point, 0x10FFFF);
+
+    // Overlong, surrogate, too large, stray continuation and truncated sequences.
+    char const* const invalid[] = { "\xC0\xAF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\x80", "\xE2\x82" };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i += 1) {
+        assert_equal(utf8_decode(invalid[i], strlen(invalid[i]), &code_point), 0);
+        assert_equal(code_point, UTF8_REPLACEMENT);
+    }
+
+    // Every valid code point survives a round trip.
+    for (uint32_t value = 0; value <= 0x10FFFF; value += 1) {
+        if (value >= 0xD800 && value <= 0xDFFF) {
+            continue;
+        }
+        char buffer[4];
+        size_t const length = utf8_encode(value, buffer);
+        assert_equal(utf8_decode(buffer, length, &code_point), length);
+        assert_equal(code_point, value);
+    }
+    return 0;
+}
+
+TEST(test_validate) {
+    char text[256];
+    memset(text, 'a', sizeof(text));
+    assert_equal(utf8_validate(text, sizeof(text)), sizeof(text));
+    assert_equal(utf8_validate(text, 0), 0);
+
+    // Invalid bytes at every offset, past the SIMD blocks and inside them.
+    for (size_t i = 0; i + 3 < sizeof(text); i += 1) {
+        memcpy(text + i, "\xE2\x82\xAC", 3);
+        assert_equal(utf8_validate(text, sizeof(text)), sizeof(text));
+        text[i + 2] = 'x';
+        assert_equal(utf8_validate(text, sizeof(text)), i);
+        memset(text + i, 'a', 3);
+    }
+
+    char const mixed[] = "caf\xC3\xA9 \xE2\x82\xAC\xF0\x9F\x90\x92\xFF";
+    assert_equal(utf8_validate(mixed, sizeof(mixed) - 2), sizeof(mixed) - 2);
+    assert_equal(utf8_validate(mixed, sizeof(mixed) - 1), sizeof(mixed) - 2);
+    return 0;
+}
+
+TEST(test_count_code_points) {
+    char text[1000];
+    size_t length = 0;
+    size_t expected = 0;
+    while (length + 4 <= sizeof(text)) {
+        length += utf8_encode((uint32_t)(expected * 7919 % 0xD000), text + length);
+        expected += 1;
+    }
+
+    assert_equal(utf8_count_code_points(text, length), expected);
+    assert_equal(utf8_count_code_points_scalar(text, length), expected);
+#ifdef LIBCHIMP_SCAN_X86
+    assert_equal(utf8_count_code_points_sse2(text, length), expected);
+    if (scan_has_avx2()) {
+        assert_equal(utf8_count_code_points_avx2(text, length), expected);
+    }
+#endif
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}
@@ -0,0 +1,140 @@
+#include "../chimp/testing.h"
+#include "../chimp/containers/Vector.h"
+
+VECTOR_DEFINE(Ints, ints, int)
+
+typedef struct Point Point;
+struct Point {
+    double x;
+    double y;
+};
+
+VECTOR_DEFINE(Points, points, Point)
+
+TEST(test_push_pop) {
+    uint8_t buffer[4096];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    Ints values = ints_create(&arena);
+
+    int value = 0;
+    assert_equal(ints_pop(&values, &value), 1);
+
+    for (int i = 0; i < 100; i += 1) {
+        assert_equal(ints_push(&values, i), 0);
+    }
+    assert_equal(values.length, 100);
+    assert_equal(values.capacity, 128);
+    assert_equal((uintptr_t)values.data % LIBCHIMP_VECTOR_ALIGNMENT, 0);
+
+    int sum = 0;
+    for (size_t i = 0; i < values.length; i += 1) {
+        sum += values.data[i];
+    }
+    assert_equal(sum, 4950);
+
+    assert_equal(ints_pop(&values, &value), 0);
+    assert_equal(value, 99);
+    assert_equal(values.length, 99);
+
+    ints_clear(&values);
+    assert_equal(values.length, 0);
+    assert_equal(values.capacity, 128);
+    return 0;
+}
+
+TEST(test_grow_in_place) {
+    uint8_t buffer[8192];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    Ints values = ints_create(&arena);
+
+    // The vector is the last allocation, so it is extended without copying.
+    assert_equal(ints_push(&values, 1), 0);
+    int* const first = values.data;
+    for (int i = 0; i < 500; i += 1) {
+        assert_equal(ints_push(&values, i), 0);
+    }
+    assert(values.data == first);
+    assert_equal(arena.offset, (uint64_t)((uint8_t*)first - buffer) + values.capacity * sizeof(int));
+
+    // Another allocation in between makes the next growth copy.
+    assert(arena_alloc(&arena, 1) != NULL);
+    assert_equal(ints_reserve(&values, values.capacity + 1), 0);
+    assert(values.data != first);
+    assert_equal((uintptr_t)values.data % LIBCHIMP_VECTOR_ALIGNMENT, 0);
+    assert_equal(values.data[0], 1);
+    assert_equal(values.data[500], 499);
+    return 0;
+}
+
+TEST(test_insert_remove) {
+    uint8_t buffer[1024];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    Ints values = ints_create(&arena);
+
+    int const initial[] = { 1, 2, 4, 5 };
+    assert_equal(ints_append(&values, initial, 4), 0);
+    assert_equal(ints_insert(&values, 2, 3), 0);
+    assert_equal(ints_insert(&values, 0, 0), 0);
+    assert_equal(ints_insert(&values, values.length, 6), 0);
+
+    assert_equal(values.length, 7);
+    for (size_t i = 0; i < values.length; i += 1) {
+        assert_equal(values.data[i], i);
+    }
+
+    assert_equal(ints_remove(&values, 3), 3);
+    assert_equal(ints_remove(&values, 0), 0);
+    assert_equal(values.length, 5);
+    assert_equal(values.data[0], 1);
+    assert_equal(values.data[2], 4);
+    assert_equal(values.data[4], 6);
+
+    Ints_Slice const slice = ints_slice(&values, 1, 4);
+    assert_equal(slice.length, 3);
+    assert_equal(slice.data[0], 2);
+    assert_equal(slice.data[2], 5);
+    return 0;
+}
+
+TEST(test_struct_elements) {
+    uint8_t buffer[1024];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    Points points = points_create(&arena);
+
+    assert_equal(points_reserve(&points, 3), 0);
+    assert_equal(points.capacity, LIBCHIMP_VECTOR_CAPACITY);
+    assert_equal(points_push(&points, (Point) { .x = 1.0, .y = 2.0 }), 0);
+    assert_equal(points_push(&points, (Point) { .x = 3.0, .y = 4.0 }), 0);
+
+    Point point = {0};
+    assert_equal(points_pop(&points, &point), 0);
+    assert_equal(point.x, 3);
+    assert_equal(point.y, 4);
+    assert_equal(points.data[0].y, 2);
+    return 0;
+}
+
+TEST(test_arena_full) {
+    uint8_t buffer[256];
+    Arena arena = arena_create(buffer, sizeof(buffer));
+    Ints values = ints_create(&arena);
+
+    int pushed = 0;
+    while (ints_push(&values, pushed) == 0) {
+        pushed += 1;
+    }
+
+    // A failed growth leaves the vector as it was.
+    assert(pushed >= 32);
+    assert_equal(values.length, pushed);
+    assert_equal(values.length, values.capacity);
+    assert_equal(values.data[pushed - 1], pushed - 1);
+    assert_equal(ints_append(&values, &pushed, 1), 1);
+    assert_equal(ints_insert(&values, 0, -1), 1);
+    assert_equal(values.data[0], 0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return testing_run(__FILE__, argc, argv);
+}